@@ -0,0 +1,70 @@
+#pragma once
+//! c/c++ headers
+#include <vector>
+//! dependency headers
+#include <armadillo>
+//! project headers
+
+namespace correspondences {
+/**
+ * @class LinearAssignment
+ *
+ * @brief shortest augmenting path (Jonker-Volgenant style) solver for linear assignment problems
+ *
+ * @note working memory is owned by the solver and is only (re)allocated when a larger problem
+ * than any previously solved one is encountered; reuse a single instance to avoid allocations
+ */
+class LinearAssignment {
+ public:
+   /** LinearAssignment::LinearAssignment()
+    * @brief default constructor
+    *
+    * @param[in]
+    * @return
+    */
+   LinearAssignment() { }
+
+   /** LinearAssignment::solve(cost, row_to_col)
+    * @brief find the permutation that minimizes the total cost of a square assignment problem
+    *
+    * @param[in] cost square cost matrix; cost(i, j) is the cost of assigning row i to column j
+    * @param[in][out] row_to_col column assigned to each row
+    * @return true if an assignment was found, false otherwise
+    */
+   bool solve(arma::mat const & cost, arma::uvec & row_to_col) noexcept;
+
+   /** LinearAssignment::solve_with_slack(profit, m, n, x_opt)
+    * @brief project a (m+1)x(n+1) score matrix with slack row and column onto the set of
+    * partial permutation matrices that maximizes the total score
+    *
+    * @param[in] profit flattened (row-major) scores, profit(i*(n+1) + j); row m and column n are
+    * the slack row and column, respectively
+    * @param[in] m number of source points (rows excluding slack)
+    * @param[in] n number of target points (columns excluding slack)
+    * @param[in][out] x_opt flattened (row-major) 0/1 assignment with the same layout as `profit`
+    * @return true if an assignment was found, false otherwise
+    *
+    * @note every source point is assigned to exactly one target point or to the slack column,
+    * and every target point is assigned to exactly one source point or to the slack row.  The
+    * slack-to-slack entry is never assigned.  Negative scores are treated as zero.
+    */
+   bool solve_with_slack(arma::colvec const & profit, size_t const & m, size_t const & n,
+       arma::colvec & x_opt) noexcept;
+
+ private:
+   /** LinearAssignment::hungarian(dim, cost)
+    * @brief core shortest augmenting path solver; result is stored in `col_to_row_`
+    *
+    * @param[in] dim size of (square) problem
+    * @param[in] cost functor returning the cost of assigning row i to column j; may return
+    * +infinity for forbidden assignments
+    * @return true if a finite-cost assignment was found, false otherwise
+    */
+   template<typename CostFn>
+   bool hungarian(size_t const & dim, CostFn const & cost) noexcept;
+
+   std::vector<double> u_, v_, minv_;  // row potentials, column potentials, reduced costs
+   std::vector<size_t> col_to_row_, way_;  // NOLINT [linelength] 1-indexed matching and augmenting path predecessors
+   std::vector<char> used_;  // columns visited in the current augmentation
+};
+}  // namespace correspondences
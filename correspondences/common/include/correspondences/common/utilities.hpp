@@ -29,6 +29,40 @@ double consistency(arma::vec3 const & si, arma::vec3 const & tj,
 WeightTensor generate_weight_tensor(arma::mat const & source_pts,
     arma::mat const & target_pts, double const & eps, double const & pw_thresh) noexcept;
 
+/**
+ * @brief leading eigenvector of the pairwise affinity matrix M with entries
+ * M((i,j), (k,l)) = -w_{ijkl} (w from `generate_weight_tensor`), found by power iteration on
+ * M + sigma*I (sigma: largest row sum of M), so that an eigenvalue -lambda_max cannot stall it
+ *
+ * @param[in] weights weight tensor (only nonzero entries are visited; M is never formed)
+ * @param[in] m number of source points
+ * @param[in] n number of target points
+ * @param[in] max_iter maximum number of power iterations
+ * @param[in] tol convergence tolerance on the change of the (unit-norm) iterate
+ * @param[in][out] x leading eigenvector (length m*n, entry i*n + j for pair (i, j))
+ * @return true if the affinity matrix is nonzero, false otherwise
+ *
+ * @note M is elementwise nonnegative, so the leading eigenvector is nonnegative; pairs with no
+ * pairwise consistency get exactly zero
+ */
+bool leading_eigenvector(WeightTensor const & weights, size_t const & m, size_t const & n,
+    size_t const & max_iter, double const & tol, arma::colvec & x) noexcept;
+
+/**
+ * @brief greedily discretize a (nonnegative) score per pair (i, j) under the one-to-one
+ * constraint: repeatedly accept the best remaining pair whose source and target are both unused
+ *
+ * @param[in] x pair scores (length m*n, entry i*n + j for pair (i, j))
+ * @param[in] m number of source points
+ * @param[in] n number of target points
+ * @param[in] max_corr maximum number of correspondences to accept
+ * @param[in] min_score pairs with score <= min_score are never accepted
+ * @param[in][out] corrs accepted correspondences, valued by their score
+ * @return
+ */
+void greedy_assignment(arma::colvec const & x, size_t const & m, size_t const & n,
+    size_t const & max_corr, double const & min_score, correspondences_t & corrs) noexcept;
+
 /**
  * @brief Find vector x that minimizes inner product <c, x> subject to bounds constraints
  * lb <= x <= ub and equality constraint A*x==b
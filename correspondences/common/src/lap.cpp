@@ -0,0 +1,178 @@
+//! c/c++ headers
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <string>
+//! dependency headers
+//! project headers
+#include "correspondences/common/lap.hpp"
+
+//! namespaces
+namespace cor = correspondences;
+
+/** LinearAssignment::hungarian(dim, cost)
+ * @brief core shortest augmenting path solver; result is stored in `col_to_row_`
+ *
+ * @param[in] dim size of (square) problem
+ * @param[in] cost functor returning the cost of assigning row i to column j; may return
+ * +infinity for forbidden assignments
+ * @return true if a finite-cost assignment was found, false otherwise
+ *
+ * @note O(dim^3); rows are added one at a time and an augmenting path is grown with
+ * Dijkstra-like updates of the dual potentials.  Index 0 is a sentinel (1-indexed storage).
+ */
+template<typename CostFn>
+bool cor::LinearAssignment::hungarian(size_t const & dim, CostFn const & cost) noexcept {
+  double const inf = std::numeric_limits<double>::infinity();
+  //! assign does not reallocate when capacity is sufficient
+  u_.assign(dim + 1, 0.);
+  v_.assign(dim + 1, 0.);
+  col_to_row_.assign(dim + 1, 0);
+  way_.assign(dim + 1, 0);
+  minv_.resize(dim + 1);
+  used_.resize(dim + 1);
+
+  for (size_t i = 1; i <= dim; ++i) {
+    col_to_row_[0] = i;
+    size_t j0 = 0;
+    std::fill(minv_.begin(), minv_.end(), inf);
+    std::fill(used_.begin(), used_.end(), 0);
+    do {
+      used_[j0] = 1;
+      size_t const i0 = col_to_row_[j0];
+      double delta = inf;
+      size_t j1 = 0;
+      for (size_t j = 1; j <= dim; ++j) {
+        if (!used_[j]) {
+          double const cur = cost(i0 - 1, j - 1) - u_[i0] - v_[j];
+          if (cur < minv_[j]) {
+            minv_[j] = cur;
+            way_[j] = j0;
+          }
+          if (minv_[j] < delta) {
+            delta = minv_[j];
+            j1 = j;
+          }
+        }
+      }
+      // LCOV_EXCL_START
+      //! no finite-cost column is reachable: the problem is infeasible
+      if (j1 == 0) {
+        return false;
+      }
+      // LCOV_EXCL_STOP
+      for (size_t j = 0; j <= dim; ++j) {
+        if (used_[j]) {
+          u_[col_to_row_[j]] += delta;
+          v_[j] -= delta;
+        } else {
+          minv_[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (col_to_row_[j0] != 0);
+
+    //! flip matching along the augmenting path
+    do {
+      size_t const j1 = way_[j0];
+      col_to_row_[j0] = col_to_row_[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+  return true;
+}
+
+/** LinearAssignment::solve(cost, row_to_col)
+ * @brief find the permutation that minimizes the total cost of a square assignment problem
+ *
+ * @param[in] cost square cost matrix; cost(i, j) is the cost of assigning row i to column j
+ * @param[in][out] row_to_col column assigned to each row
+ * @return true if an assignment was found, false otherwise
+ */
+bool cor::LinearAssignment::solve(arma::mat const & cost, arma::uvec & row_to_col) noexcept {
+  // LCOV_EXCL_START
+  if (cost.n_rows != cost.n_cols) {
+    std::cout << static_cast<std::string>(__func__)
+      << ": First argument must be a square matrix" << std::endl;
+    return false;
+  }
+  // LCOV_EXCL_STOP
+
+  size_t const dim = cost.n_rows;
+  if (!hungarian(dim, [&](size_t const & i, size_t const & j) { return cost(i, j); })) {
+    return false;  // LCOV_EXCL_LINE
+  }
+
+  row_to_col.set_size(dim);
+  for (size_t j = 1; j <= dim; ++j) {
+    row_to_col(col_to_row_[j] - 1) = j - 1;
+  }
+  return true;
+}
+
+/** LinearAssignment::solve_with_slack(profit, m, n, x_opt)
+ * @brief project a (m+1)x(n+1) score matrix with slack row and column onto the set of
+ * partial permutation matrices that maximizes the total score
+ *
+ * @param[in] profit flattened (row-major) scores, profit(i*(n+1) + j); row m and column n are
+ * the slack row and column, respectively
+ * @param[in] m number of source points (rows excluding slack)
+ * @param[in] n number of target points (columns excluding slack)
+ * @param[in][out] x_opt flattened (row-major) 0/1 assignment with the same layout as `profit`
+ * @return true if an assignment was found, false otherwise
+ *
+ * @note the slack row/column are expanded (implicitly) into an (m+n)x(m+n) square problem:
+ *
+ *   | source -> target (m x n)    | source -> slack (m x m, diagonal) |
+ *   | slack -> target (n x n, diag) | slack -> slack (n x m, zeros)   |
+ *
+ * off-diagonal entries of the slack blocks are forbidden.  Costs are evaluated on the fly, so
+ * no (m+n)x(m+n) matrix is ever formed.
+ */
+bool cor::LinearAssignment::solve_with_slack(arma::colvec const & profit, size_t const & m,
+    size_t const & n, arma::colvec & x_opt) noexcept {
+  // LCOV_EXCL_START
+  if (profit.n_elem != (m + 1) * (n + 1)) {
+    std::cout << static_cast<std::string>(__func__)
+      << ": First argument must have (m+1)*(n+1) elements" << std::endl;
+    return false;
+  } else if (x_opt.n_elem != profit.n_elem) {
+    std::cout << static_cast<std::string>(__func__)
+      << ": First and fourth arguments must have the same number of elements" << std::endl;
+    return false;
+  }
+  // LCOV_EXCL_STOP
+
+  double const inf = std::numeric_limits<double>::infinity();
+  size_t const stride = n + 1;
+  auto const cost = [&](size_t const & r, size_t const & c) -> double {
+    if (r < m) {
+      if (c < n) {
+        return -std::max(profit(r*stride + c), 0.);
+      }
+      return (c - n == r) ? -std::max(profit(r*stride + n), 0.) : inf;
+    }
+    if (c < n) {
+      return (r - m == c) ? -std::max(profit(m*stride + c), 0.) : inf;
+    }
+    return 0.;
+  };
+
+  if (!hungarian(m + n, cost)) {
+    return false;  // LCOV_EXCL_LINE
+  }
+
+  x_opt.zeros();
+  for (size_t c = 1; c <= m + n; ++c) {
+    size_t const r = col_to_row_[c] - 1;
+    size_t const col = c - 1;
+    if (r < m && col < n) {
+      x_opt(r*stride + col) = 1;  // source -> target
+    } else if (r < m) {
+      x_opt(r*stride + n) = 1;  // source -> slack
+    } else if (col < n) {
+      x_opt(m*stride + col) = 1;  // slack -> target
+    }
+  }
+  return true;
+}
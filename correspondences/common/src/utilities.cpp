@@ -1,5 +1,7 @@
 //! c/c++ headers
+#include <limits>
 #include <map>
+#include <utility>
 #include <vector>
 //! dependency headers
 #include <ortools/linear_solver/linear_solver.h>  // NOLINT [build/include_order]
@@ -62,6 +64,92 @@ cor::WeightTensor cor::generate_weight_tensor(arma::mat const & source_pts,
   return weight;
 }
 
+/**
+ * @brief leading eigenvector of the pairwise affinity matrix M with entries
+ * M((i,j), (k,l)) = -w_{ijkl} (w from `generate_weight_tensor`), found by power iteration on
+ * M + sigma*I (sigma: largest row sum of M), so that an eigenvalue -lambda_max cannot stall it
+ *
+ * @param[in] weights weight tensor (only nonzero entries are visited; M is never formed)
+ * @param[in] m number of source points
+ * @param[in] n number of target points
+ * @param[in] max_iter maximum number of power iterations
+ * @param[in] tol convergence tolerance on the change of the (unit-norm) iterate
+ * @param[in][out] x leading eigenvector (length m*n, entry i*n + j for pair (i, j))
+ * @return true if the affinity matrix is nonzero, false otherwise
+ */
+bool cor::leading_eigenvector(cor::WeightTensor const & weights, size_t const & m,
+    size_t const & n, size_t const & max_iter, double const & tol, arma::colvec & x) noexcept {
+  //! shift: iterate on M + sigma*I with sigma the largest row sum of M (>= its spectral radius).
+  //! M is nonnegative with a zero diagonal, so -lambda_max can be an eigenvalue too (e.g. when the
+  //! consistent pairs form a bipartite graph) and the unshifted iterate would alternate between
+  //! two vectors; the shift keeps the eigenvectors and makes the leading eigenvalue dominant
+  arma::colvec row_sums(m * n, arma::fill::zeros);
+  for (auto const & [key, w] : weights) {
+    auto const & [i, j, k, l] = key;
+    row_sums(i*n + j) -= w;
+  }
+  double const sigma = row_sums.is_empty() ? 0. : row_sums.max();
+  if (sigma <= std::numeric_limits<double>::epsilon()) {
+    return false;
+  }
+  //! start on the pairs with some pairwise consistency only, so that the others (which the shift
+  //! would otherwise carry along) stay exactly zero
+  x.zeros(m * n);
+  x.elem(arma::find(row_sums > 0)).ones();
+  x /= arma::norm(x, 2);
+  arma::colvec y(m * n);
+  for (size_t it = 0; it < max_iter; ++it) {
+    //! y = (M + sigma*I) * x, visiting only nonzero entries of M
+    y = sigma * x;
+    for (auto const & [key, w] : weights) {
+      auto const & [i, j, k, l] = key;
+      y(i*n + j) -= w * x(k*n + l);
+    }
+    double const nrm = arma::norm(y, 2);
+    if (nrm <= std::numeric_limits<double>::epsilon()) {
+      return false;
+    }
+    y /= nrm;
+    double const change = arma::norm(y - x, 2);
+    x.swap(y);
+    if (change < tol) {
+      break;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief greedily discretize a (nonnegative) score per pair (i, j) under the one-to-one
+ * constraint: repeatedly accept the best remaining pair whose source and target are both unused
+ *
+ * @param[in] x pair scores (length m*n, entry i*n + j for pair (i, j))
+ * @param[in] m number of source points
+ * @param[in] n number of target points
+ * @param[in] max_corr maximum number of correspondences to accept
+ * @param[in] min_score pairs with score <= min_score are never accepted
+ * @param[in][out] corrs accepted correspondences, valued by their score
+ * @return
+ */
+void cor::greedy_assignment(arma::colvec const & x, size_t const & m, size_t const & n,
+    size_t const & max_corr, double const & min_score, cor::correspondences_t & corrs) noexcept {
+  corrs.clear();
+  std::vector<char> src_used(m, 0), tgt_used(n, 0);
+  arma::uvec const best_to_worst = arma::sort_index(x, "descend");
+  for (auto const & idx : best_to_worst) {
+    if (corrs.size() >= max_corr || x(idx) <= min_score) {
+      break;
+    }
+    size_t const i = idx / n;
+    size_t const j = idx % n;
+    if (!src_used[i] && !tgt_used[j]) {
+      src_used[i] = tgt_used[j] = 1;
+      corrs[std::make_pair(i, j)] = x(idx);
+    }
+  }
+  return;
+}
+
 /**
  * @brief Finds x that minimizes inner product <c, x> subject to:
  * (1) bounds constraints lb <= x <= ub, and
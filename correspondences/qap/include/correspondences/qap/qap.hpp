@@ -7,6 +7,7 @@
 #include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 //! dependency headers
 #include <armadillo>
 #include <boost/functional/hash.hpp>
@@ -15,11 +16,22 @@
 #include "nlohmann/json.hpp"
 //! project headers
 #include "correspondences/common/base.hpp"
+#include "correspondences/common/lap.hpp"
 #include "correspondences/common/types.hpp"
 #include "correspondences/common/utilities.hpp"
 
 namespace correspondences {
 namespace qap {
+/**
+ * @enum class init_e
+ *
+ * @brief available strategies for the initial point passed to IPOPT
+ */
+enum class init_e {
+  zero = 0,  //! start from z = 0
+  spectral = 1  //! start from greedily-discretized leading eigenvector of the affinity matrix
+};
+
 /** @struct Config
  * @brief configuration parameters for optimization algorithm 
  * @var Config::corr_threshold
@@ -28,6 +40,10 @@ namespace qap {
  * minimum number of pairwise consistencies 
  * @var Config::min_corr
  * number of correspondences/matches to identify during optimization 
+ * @var Config::init
+ * initialization (warm start) strategy for IPOPT; see `init_e`
+ * @var Config::ipopt_print_level
+ * IPOPT output verbosity (>= 5 reports the number of iterations for each solve)
  */
 struct Config : CorrespondencesConfigBase {
   Config()
@@ -41,16 +57,22 @@ struct Config : CorrespondencesConfigBase {
       json_utils::check_for_param(config, "corr_threshold", corr_threshold);
       json_utils::check_for_param(config, "n_pair_threshold", n_pair_threshold);
       json_utils::check_for_param(config, "min_corr", min_corr);
+      json_utils::check_for_param(config, "initialization", init);
+      json_utils::check_for_param(config, "ipopt_print_level", ipopt_print_level);
     }
 
   void set_defaults() noexcept final {
     corr_threshold = 0.9;
     n_pair_threshold = 5;
     min_corr = 5;
+    init = init_e::zero;
+    ipopt_print_level = 0;
   }
 
   double corr_threshold;
   size_t n_pair_threshold, min_corr;
+  init_e init;
+  size_t ipopt_print_level;
 };
 
 /** @class ConstrainedObjective
@@ -78,6 +100,7 @@ class ConstrainedObjective {
      weights_ = generate_weight_tensor(source_pts, target_pts, config.epsilon,
          config.pairwise_dist_threshold);
      n_constraints_ = m_ + n_ + 2;
+     eliminate_unsupported();
    }
 
    /** ConstrainedObjective::~ConstrainedObjective()
@@ -138,17 +161,57 @@ class ConstrainedObjective {
     */
    size_t state_length() const noexcept { return (m_ + 1) * (n_ + 1); }
 
+   /** ConstrainedObjective::num_vars()
+    * @brief get number of free variables in the (reduced) optimization problem
+    *
+    * @param[in]
+    * @return number of variables not eliminated; see `eliminate_unsupported`
+    */
+   size_t num_vars() const noexcept { return full_index_.size(); }
+
+   /** ConstrainedObjective::num_supported()
+    * @brief get number of (non-slack) correspondence variables that have at least one
+    * pairwise consistency
+    *
+    * @param[in]
+    * @return copy of private member `n_supported_`
+    */
+   size_t num_supported() const noexcept { return n_supported_; }
+
+   /** ConstrainedObjective::full_index(r)
+    * @brief map index of reduced state onto index of full state (length `state_length()`)
+    *
+    * @param[in] r index into reduced state
+    * @return index into full state
+    */
+   size_t full_index(size_t const & r) const noexcept { return full_index_[r]; }
+
    /** ConstrainedObjective::get_weight_tensor()
     * @brief get weight_tensor
     *
     * @param[in]
-    * @return copy of private member `weights_`
+    * @return const reference to private member `weights_`
     */
-   WeightTensor get_weight_tensor() const noexcept { return weights_; }
+   WeightTensor const & get_weight_tensor() const noexcept { return weights_; }
 
  private:
+   /** ConstrainedObjective::eliminate_unsupported()
+    * @brief fix correspondence variables that appear in no pairwise consistency to zero and
+    * build the reduced objective/constraint structure over the remaining variables
+    *
+    * @param[in]
+    * @return
+    *
+    * @note such variables do not contribute to the objective, so they could only ever be
+    * assigned to make up the correspondence count; slack variables are always kept
+    */
+   void eliminate_unsupported() noexcept;
+
    WeightTensor weights_;
-   size_t m_, n_, min_corr_, n_constraints_;
+   size_t m_, n_, min_corr_, n_constraints_, n_supported_;
+   std::vector<size_t> full_index_;  //! reduced state index -> full state index
+   std::vector<std::tuple<size_t, size_t, double>> terms_;  // NOLINT [linelength] objective terms (reduced indices and weight)
+   std::vector<std::vector<size_t>> constraint_vars_;  // NOLINT [linelength] reduced indices summed in each constraint
 };
 }  // namespace qap
 
@@ -221,16 +284,25 @@ class QAP : public CorrespondencesBase {
     */
    arma::colvec get_optimum() const noexcept { return optimum_; }
 
+   /** QAP::spectral_guess(z0)
+    * @brief build a feasible 0/1 initial guess (full state) from the greedily-discretized
+    * leading eigenvector of the pairwise affinity matrix
+    *
+    * @param[in][out] z0 initial guess with length `state_length()`
+    * @return true if the affinity matrix is nonzero, false otherwise
+    */
+   bool spectral_guess(arma::colvec & z0) const noexcept;
+
    /** QAP::linear_projection
     * @brief Solve linear assignment problem:
-    *  max c.t()*flatten(X) subject to linear constraints
+    *  max c.t()*flatten(X) subject to assignment constraints (with slack row and column)
     *
-    * @note linear constraints are constructed within the function
+    * @note solved with `LinearAssignment`; see lap.hpp
     *
     * @param [in][out] opt_lp projection of optimal solution onto permutation matrices
     * @return true if converged, false otherwise
     */
-   bool linear_projection(arma::colvec & opt_lp) const noexcept;
+   bool linear_projection(arma::colvec & opt_lp) noexcept;
 
    /** QAP::num_consistent_pairs()
     * @brief get identified correspondences
@@ -244,5 +316,6 @@ class QAP : public CorrespondencesBase {
    qap::Config config_;
    std::unique_ptr<qap::ConstrainedObjective> ptr_obj_;
    arma::colvec optimum_;
+   LinearAssignment lap_;  //! reusable workspace for `linear_projection`
 };
 }  // namespace correspondences
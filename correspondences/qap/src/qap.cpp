@@ -29,56 +29,99 @@ namespace cq = cor::qap;
 cq::ConstrainedObjective::~ConstrainedObjective() { }
 // LCOV_EXCL_STOP
 
-/** ConstrainedObjective::operator()
- * @brief operator overload for IPOPT
+/** ConstrainedObjective::eliminate_unsupported()
+ * @brief fix correspondence variables that appear in no pairwise consistency to zero and
+ * build the reduced objective/constraint structure over the remaining variables
  *
- * @param[in][out] fgrad objective function evaluation (including constraints) at point `z`
- * @param[in] z point for evaluation
- * return
+ * @param[in]
+ * @return
  */
-void cq::ConstrainedObjective::operator()(cq::ConstrainedObjective::ADvector &fgrad,
-    cq::ConstrainedObjective::ADvector const & z) noexcept {
-  size_t curr_idx = 0;
-  //! objective value
-  fgrad[curr_idx] = 0.;
+void cq::ConstrainedObjective::eliminate_unsupported() noexcept {
+  size_t const stride = n_ + 1;
+  size_t const npos = std::numeric_limits<size_t>::max();
+
+  //! mark (i, j) pairs that appear in at least one pairwise consistency
+  std::vector<char> supported(state_length(), 0);
+  for (auto const & [key, w] : weights_) {
+    supported[std::get<0>(key)*stride + std::get<1>(key)] = 1;
+    supported[std::get<2>(key)*stride + std::get<3>(key)] = 1;
+  }
+  n_supported_ = static_cast<size_t>(std::count(supported.cbegin(), supported.cend(), 1));
+
+  //! slack variables are always free, except for the slack-to-slack entry (fixed to 0)
   for (size_t i = 0; i < m_; ++i) {
-    for (size_t j = 0; j < n_; ++j) {
-      for (size_t k = 0; k < m_; ++k) {
-        for (size_t l = 0; l < n_; ++l) {
-          if (i != k && j != l) {
-            WeightKey_t const key = std::make_tuple(i, j, k, l);
-            if (weights_.find(key) != weights_.end()) {
-              fgrad[curr_idx] += weights_[key] * z[i*(n_+1) + j] * z[k*(n_+1) + l];
-            }
-          }
-        }
-      }
+    supported[i*stride + n_] = 1;
+  }
+  for (size_t j = 0; j < n_; ++j) {
+    supported[m_*stride + j] = 1;
+  }
+
+  std::vector<size_t> reduced_index(state_length(), npos);
+  full_index_.clear();
+  for (size_t f = 0; f < state_length(); ++f) {
+    if (supported[f]) {
+      reduced_index[f] = full_index_.size();
+      full_index_.emplace_back(f);
     }
   }
 
-  //! constraints:
+  //! objective terms: every weight references two supported variables
+  terms_.clear();
+  terms_.reserve(weights_.size());
+  for (auto const & [key, w] : weights_) {
+    size_t const a = reduced_index[std::get<0>(key)*stride + std::get<1>(key)];
+    size_t const b = reduced_index[std::get<2>(key)*stride + std::get<3>(key)];
+    terms_.emplace_back(a, b, w);
+  }
+
+  //! constraints (same order as bounds set in QAP::calc_optimum):
+  //! rows 0..m-1, slack row, columns 0..n-1, slack column
+  constraint_vars_.assign(n_constraints_, {});
+  auto add_if_free = [&](size_t const & con, size_t const & f) {
+    if (reduced_index[f] != npos) {
+      constraint_vars_[con].emplace_back(reduced_index[f]);
+    }
+  };
   for (size_t i = 0; i < m_; ++i) {
-    ++curr_idx;
     for (size_t j = 0; j <= n_; ++j) {
-      fgrad[curr_idx] += z[i*(n_+1) + j];
+      add_if_free(i, i*stride + j);
     }
   }
-
-  ++curr_idx;
   for (size_t j = 0; j < n_; ++j) {
-    fgrad[curr_idx] += z[m_*(n_+1) + j];
+    add_if_free(m_, m_*stride + j);
   }
-
   for (size_t j = 0; j < n_; ++j) {
-    ++curr_idx;
     for (size_t i = 0; i <= m_; ++i) {
-      fgrad[curr_idx] += z[i*(n_+1) + j];
+      add_if_free(m_ + 1 + j, i*stride + j);
     }
   }
-
-  ++curr_idx;
   for (size_t i = 0; i < m_; ++i) {
-    fgrad[curr_idx] += z[i*(n_+1) + n_];
+    add_if_free(m_ + n_ + 1, i*stride + n_);
+  }
+  return;
+}
+
+/** ConstrainedObjective::operator()
+ * @brief operator overload for IPOPT
+ *
+ * @param[in][out] fgrad objective function evaluation (including constraints) at point `z`
+ * @param[in] z point for evaluation (reduced state; see `eliminate_unsupported`)
+ * return
+ */
+void cq::ConstrainedObjective::operator()(cq::ConstrainedObjective::ADvector &fgrad,
+    cq::ConstrainedObjective::ADvector const & z) noexcept {
+  //! objective value
+  fgrad[0] = 0.;
+  for (auto const & [a, b, w] : terms_) {
+    fgrad[0] += w * z[a] * z[b];
+  }
+
+  //! constraints:
+  for (size_t c = 0; c < n_constraints_; ++c) {
+    fgrad[c+1] = 0.;
+    for (auto const & r : constraint_vars_[c]) {
+      fgrad[c+1] += z[r];
+    }
   }
 }
 
@@ -96,42 +139,59 @@ cor::QAP::~QAP() { }
 
 /** QAP::linear_projection
  * @brief Solve linear assignment problem:
- *  max c.t()*flatten(X) subject to linear constraints
+ *  max c.t()*flatten(X) subject to assignment constraints (with slack row and column)
  *
- * @note linear constraints are constructed within the function
+ * @note negative entries of the optimum never contribute to the projection
  *
  * @param [in][out] opt_lp projection of optimal solution onto permutation matrices
  * @return true if converged, false otherwise
  */
-bool cor::QAP::linear_projection(arma::colvec & opt_lp) const noexcept {
+bool cor::QAP::linear_projection(arma::colvec & opt_lp) noexcept {
   auto const & m = ptr_obj_->num_source_pts();
   auto const & n = ptr_obj_->num_target_pts();
-  auto const & n_con = ptr_obj_->num_constraints();
-  auto const & state_len = ptr_obj_->state_length();
-
-  //! make copy of optimum_ (with slack variables)
-  arma::colvec c(optimum_);
 
-  //! negate positive values
-  c.transform( [&](double & val) { return (val < 0) ? static_cast<double>(0) : -val; } );
+  //! find projection
+  return lap_.solve_with_slack(optimum_, m, n, opt_lp);
+}
 
-  arma::mat A(n_con, state_len, arma::fill::zeros);
-  arma::colvec b(n_con, arma::fill::ones);
+/** QAP::spectral_guess(z0)
+ * @brief build a feasible 0/1 initial guess (full state) from the greedily-discretized
+ * leading eigenvector of the pairwise affinity matrix
+ *
+ * @param[in][out] z0 initial guess with length `state_length()`
+ * @return true if the affinity matrix is nonzero, false otherwise
+ */
+bool cor::QAP::spectral_guess(arma::colvec & z0) const noexcept {
+  auto const & m = ptr_obj_->num_source_pts();
+  auto const & n = ptr_obj_->num_target_pts();
+  size_t const stride = n + 1;
 
-  //! \sum_i Xi,j = 1
-  for (size_t i = 0; i <= m; ++i) {
-    A(i, arma::span(i*(n+1), (i+1)*(n+1)-1)).fill(1);
+  arma::colvec x;
+  if (!leading_eigenvector(ptr_obj_->get_weight_tensor(), m, n, 100, 1e-6, x)) {
+    return false;
   }
+  correspondences_t corrs;
+  greedy_assignment(x, m, n, ptr_obj_->num_min_corr(), 0., corrs);
 
-  //! \sum_j Xi,j = 1
-  for (size_t i = m+1; i < n_con; ++i) {
-    for (size_t j = 0; j < state_len; j+=n+1) {
-      A(i, j) = 1;
+  //! matched pairs get 1, everything left unmatched is assigned to slack
+  z0.zeros(ptr_obj_->state_length());
+  std::vector<char> src_used(m, 0), tgt_used(n, 0);
+  for (auto const & c : corrs) {
+    auto const & [i, j] = c.first;
+    z0(i*stride + j) = 1;
+    src_used[i] = tgt_used[j] = 1;
+  }
+  for (size_t i = 0; i < m; ++i) {
+    if (!src_used[i]) {
+      z0(i*stride + n) = 1;
     }
   }
-
-  //! find projection
-  return linear_programming(c, A, b, static_cast<double>(0), static_cast<double>(1), opt_lp);
+  for (size_t j = 0; j < n; ++j) {
+    if (!tgt_used[j]) {
+      z0(m*stride + j) = 1;
+    }
+  }
+  return true;
 }
 
 /** QAP::calc_optimum()
@@ -147,20 +207,38 @@ cor::QAP::ipopt_status_t cor::QAP::calc_optimum() noexcept {
   auto const & m = ptr_obj_->num_source_pts();
   auto const & n = ptr_obj_->num_target_pts();
   auto const & k = ptr_obj_->num_min_corr();
-  auto const & n_vars = ptr_obj_->state_length();
+  auto const & n_vars = ptr_obj_->num_vars();
   auto const & n_constraints = ptr_obj_->num_constraints();
 
+  //! not enough supported correspondences to reach the requested count: skip the NLP
+  if (ptr_obj_->num_supported() < k) {
+    return ipopt_status_t::local_infeasibility;
+  }
+
+  //! initial point (reduced state): IPOPT's default is z = 0
   Dvec z(n_vars);
+  for (size_t i = 0; i < n_vars; ++i) {
+    z[i] = 0;
+  }
+  arma::colvec z0;
+  bool warm_start = false;
+  if (config_.init == qap::init_e::spectral) {
+    warm_start = spectral_guess(z0);
+  }
+  if (warm_start) {
+    for (size_t i = 0; i < n_vars; ++i) {
+      z[i] = z0(ptr_obj_->full_index(i));
+    }
+  }
 
   //! setup inequality constraints on variables: 0 <= z_{ij} <= 1 for all i,j
+  //! @note eliminated variables (including slack-to-slack) are not part of the NLP
   Dvec z_lb(n_vars);
   Dvec z_ub(n_vars);
   for (size_t i = 0; i < n_vars; ++i) {
     z_lb[i] = 0;
     z_ub[i] = 1;
   }
-  //! overwrite last value to avoid checking conditional for all iterations
-  z_ub[n_vars-1] = 0;
 
   //! setup constraints l_i <= g_i(z) <= u_i
   Dvec constraints_lb(n_constraints);
@@ -182,7 +260,7 @@ cor::QAP::ipopt_status_t cor::QAP::calc_optimum() noexcept {
 
   //! options for IPOPT solver
   std::string options;
-  options += "Integer print_level  0\n";
+  options += "Integer print_level  " + std::to_string(config_.ipopt_print_level) + "\n";
   /**
    * NOTE: Setting sparse to true allows the solver to take advantage
    * of sparse routines, this makes the computation MUCH FASTER. If you
@@ -198,6 +276,18 @@ cor::QAP::ipopt_status_t cor::QAP::calc_optimum() noexcept {
   //! timeout period (sec).
   options += "Numeric max_cpu_time          1000.0\n";
 
+  /**
+   * NOTE: with a good initial point, keep the barrier parameter small and only push the point
+   * slightly away from its bounds so that IPOPT starts near the initial guess instead of
+   * recentering it.  (`warm_start_init_point` also requires bound and constraint multipliers,
+   * which CppAD::ipopt::solve does not accept.)
+   */
+  if (warm_start) {
+    options += "Numeric mu_init     1e-3\n";
+    options += "Numeric bound_push  1e-3\n";
+    options += "Numeric bound_frac  1e-3\n";
+  }
+
   //! solve the problem
   CppAD::ipopt::solve_result<Dvec> solution;
   CppAD::ipopt::solve<Dvec, qap::ConstrainedObjective>(
@@ -207,14 +297,15 @@ cor::QAP::ipopt_status_t cor::QAP::calc_optimum() noexcept {
   if (solution.status != ipopt_status_t::success) {
     return solution.status;
   }
-  //! overwrite private member optimum_ with result and
-  //! return success
+  //! overwrite private member optimum_ with result (expanded back onto the full state,
+  //! eliminated variables are zero) and return success
+  optimum_.zeros();
   for (size_t i = 0; i < n_vars; ++i) {
-    optimum_(i) = solution.x[i];
+    optimum_(ptr_obj_->full_index(i)) = solution.x[i];
   }
 
   //! project onto permutation matrices; see Section 3.3 of the SDRSAC paper
-  arma::colvec proj_opt(n_vars);
+  arma::colvec proj_opt(optimum_.n_elem);
   if (linear_projection(proj_opt)) {
     //! only update optimum_ if linear_projection was successful
     optimum_ = proj_opt;
@@ -0,0 +1,206 @@
+#pragma once
+//! c/c++ headers
+#include <tuple>
+#include <utility>
+#include <vector>
+//! dependency headers
+#include <armadillo>
+#include <nlohmann/json.hpp>
+//! project headers
+#include "correspondences/common/base.hpp"
+#include "correspondences/common/types.hpp"
+#include "correspondences/common/utilities.hpp"
+
+namespace correspondences {
+namespace sdp {
+
+/** @struct Config : CorrespondencesConfigBase
+ * @var Config::rank
+ * number of columns of the low-rank factor V (Y = V*V.t()) {>= 2}
+ * @var Config::max_iter
+ * maximum number of augmented Lagrangian (outer) iterations
+ * @var Config::max_inner_iter
+ * maximum number of gradient steps per outer iteration
+ * @var Config::rho
+ * initial penalty parameter
+ * @var Config::rho_max
+ * upper bound on penalty parameter
+ * @var Config::tol
+ * convergence tolerance on (max absolute) constraint violation
+ * @var Config::corr_threshold
+ * minimum score (relative to the best-scoring pair) to accept a correspondence {\in (0, 1]}
+ * @var Config::seed
+ * seed for the (random) initial factor
+ */
+struct Config : CorrespondencesConfigBase {
+  Config()
+    : CorrespondencesConfigBase() {
+      set_defaults();
+    }
+
+  explicit Config(nlohmann::json & config) :
+    CorrespondencesConfigBase(config) {
+      set_defaults();
+      json_utils::check_for_param(config, "rank", rank);
+      json_utils::check_for_param(config, "max_iter", max_iter);
+      json_utils::check_for_param(config, "max_inner_iter", max_inner_iter);
+      json_utils::check_for_param(config, "rho", rho);
+      json_utils::check_for_param(config, "rho_max", rho_max);
+      json_utils::check_for_param(config, "tol", tol);
+      json_utils::check_for_param(config, "corr_threshold", corr_threshold);
+      json_utils::check_for_param(config, "seed", seed);
+    }
+
+  void set_defaults() noexcept final {
+    rank = 8;
+    max_iter = 20;
+    max_inner_iter = 500;
+    rho = 1;
+    rho_max = 1e4;
+    tol = 1e-3;
+    corr_threshold = 0.9;
+    seed = 0;
+  }
+
+  size_t rank;
+  size_t max_iter;
+  size_t max_inner_iter;
+  double rho;
+  double rho_max;
+  double tol;
+  double corr_threshold;
+  size_t seed;
+};
+}  // namespace sdp
+
+/** @class SDP : public CorrespondencesBase
+ * @brief wrapper class definition for correspondence calculation by a semidefinite relaxation
+ * of the correspondence problem, solved in low-rank (Burer-Monteiro) form
+ *
+ * @note the lifted matrix Y = [1 x.t(); x X] is factored as Y = V*V.t() with rows v_0 = e_1 and
+ * v_a for each candidate pair a = (i, j), so that x_a = v_a(0).  The relaxation maximizes
+ * <-w, X> subject to:
+ *   - X_aa = x_a (i.e. ||v_a||^2 = v_a(0)), and
+ *   - X_ab = 0 for conflicting pairs a, b (same source or same target point).
+ * Together with Y >= 0 these imply the one-to-one constraints sum_j x_ij <= 1 and
+ * sum_i x_ij <= 1, so the relaxation is at least as tight as the QAP relaxation.  Pairs without
+ * any pairwise consistency are eliminated up front.
+ */
+class SDP : public CorrespondencesBase {
+ public:
+   /** SDP::SDP(source_pts, target_pts, config)
+    * @brief constructor for semidefinite relaxation wrapper class
+    *
+    * @param[in] source_pts distribution of (columnar) source points
+    * @param[in] target_pts distribution of (columnar) target points
+    * @param[in] config `Config` instance with algorithm parameters; see `Config` definition
+    * @return
+    */
+   explicit SDP(arma::mat const & source_pts,
+       arma::mat const & target_pts, sdp::Config config)
+     : config_(config)
+     , weights_(generate_weight_tensor(source_pts, target_pts,
+         config_.epsilon, config_.pairwise_dist_threshold))
+     , m_(source_pts.n_cols)
+     , n_(target_pts.n_cols) {
+     build_problem();
+   }
+
+   /** SDP::~SDP()
+    * @brief destructor for semidefinite relaxation wrapper class
+    *
+    * @param[in]
+    * @return
+    */
+   ~SDP();
+
+   /** SDP::calc_relaxation()
+    * @brief solve the low-rank relaxation with an augmented Lagrangian method; each subproblem
+    * is minimized by gradient descent with Barzilai-Borwein steps and backtracking
+    *
+    * @param[in]
+    * @return true if the constraint violation dropped below `Config::tol`, false otherwise
+    */
+   bool calc_relaxation() noexcept;
+
+   /** SDP::calc_correspondences()
+    * @brief identify pairwise correspondences between source and target set by rounding the
+    * solution of the relaxation
+    *
+    * @param[in][out] corr correspondences found; values are scores relative to the best pair
+    * @return solution status
+    * @see status_e definition in types.hpp
+    */
+   status_e calc_correspondences(correspondences_t & corr) noexcept final;
+
+   /** SDP::get_optimum()
+    * @brief get (relaxed) correspondence scores x_a = v_a(0) from the last relaxation solved
+    *
+    * @param[in]
+    * @return scores (length m*n, entry i*n + j for pair (i, j))
+    */
+   arma::colvec get_optimum() const noexcept;
+
+   /** SDP::num_supported()
+    * @brief get number of candidate pairs with at least one pairwise consistency
+    *
+    * @param[in]
+    * @return number of columns of the factor V (excluding v_0)
+    */
+   size_t num_supported() const noexcept { return full_index_.size(); }
+
+   /** SDP::num_conflicts()
+    * @brief get number of pairs of candidates that share a source or target point
+    *
+    * @param[in]
+    * @return number of (off-diagonal) zero constraints
+    */
+   size_t num_conflicts() const noexcept { return conflicts_.size(); }
+
+   /** SDP::num_consistent_pairs()
+    * @brief get identified correspondences
+    *
+    * @param[in]
+    * @return number of pairwise consistencies identified
+    */
+   size_t num_consistent_pairs() const noexcept { return weights_.size(); }
+
+ private:
+   /** SDP::build_problem()
+    * @brief map candidate pairs with nonzero support onto columns of the factor and build the
+    * objective terms and conflict list over those columns
+    *
+    * @param[in]
+    * @return
+    */
+   void build_problem() noexcept;
+
+   /** SDP::lagrangian(V, grad)
+    * @brief evaluate the augmented Lagrangian and its gradient at factor V; matrix-free, cost is
+    * linear in the number of objective terms and constraints
+    *
+    * @param[in] V factor (rank x num_supported); column a is v_a without v_0
+    * @param[in][out] grad gradient with respect to V
+    * @return value of augmented Lagrangian
+    */
+   double lagrangian(arma::mat const & V, arma::mat & grad) const noexcept;
+
+   /** SDP::max_violation(V)
+    * @brief largest absolute constraint violation at factor V
+    *
+    * @param[in] V factor (rank x num_supported)
+    * @return max over constraints of |h(V)|
+    */
+   double max_violation(arma::mat const & V) const noexcept;
+
+   sdp::Config config_;  //! initialization data struct
+   WeightTensor weights_;  //! pairwise consistencies
+   size_t m_, n_;  //! no. of source and target points
+   std::vector<size_t> full_index_;  //! column of V -> pair index i*n + j
+   std::vector<std::tuple<size_t, size_t, double>> terms_;  // NOLINT [linelength] objective terms (columns of V and weight)
+   std::vector<std::pair<size_t, size_t>> conflicts_;  //! columns with X_ab == 0
+   arma::mat V_;  //! low-rank factor from last call to `calc_relaxation`
+   arma::colvec lambda_, mu_;  //! multipliers for diagonal and conflict constraints
+   double rho_;  //! current penalty parameter
+};
+}  // namespace correspondences
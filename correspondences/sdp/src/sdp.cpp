@@ -0,0 +1,319 @@
+//! c/c++ headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+//! dependency headers
+//! project headers
+#include "correspondences/sdp/sdp.hpp"
+
+//! namespaces
+namespace cor = correspondences;
+
+namespace {
+/**
+ * @brief inner product of two columns of length r
+ *
+ * @param[in] a pointer to first column
+ * @param[in] b pointer to second column
+ * @param[in] r column length
+ * @return <a, b>
+ */
+inline double col_dot(double const * a, double const * b, size_t const & r) noexcept {
+  double s = 0;
+  for (size_t k = 0; k < r; ++k) {
+    s += a[k] * b[k];
+  }
+  return s;
+}
+
+/**
+ * @brief y += alpha * x for columns of length r
+ *
+ * @param[in] alpha scale factor
+ * @param[in] x pointer to column to add
+ * @param[in][out] y pointer to column to update
+ * @param[in] r column length
+ * @return
+ */
+inline void col_axpy(double const & alpha, double const * x, double * y,
+    size_t const & r) noexcept {
+  for (size_t k = 0; k < r; ++k) {
+    y[k] += alpha * x[k];
+  }
+}
+}  // namespace
+
+// LCOV_EXCL_START
+/** SDP::~SDP()
+ * @brief destructor for semidefinite relaxation wrapper class
+ *
+ * @param[in]
+ * @return
+ *
+ * @note nothing to do; resources are automatically deleted
+ */
+cor::SDP::~SDP() { }
+// LCOV_EXCL_STOP
+
+/** SDP::build_problem()
+ * @brief map candidate pairs with nonzero support onto columns of the factor and build the
+ * objective terms and conflict list over those columns
+ *
+ * @param[in]
+ * @return
+ */
+void cor::SDP::build_problem() noexcept {
+  size_t const npos = std::numeric_limits<size_t>::max();
+
+  //! mark (i, j) pairs that appear in at least one pairwise consistency
+  std::vector<char> supported(m_ * n_, 0);
+  for (auto const & [key, w] : weights_) {
+    supported[std::get<0>(key)*n_ + std::get<1>(key)] = 1;
+    supported[std::get<2>(key)*n_ + std::get<3>(key)] = 1;
+  }
+
+  //! columns are assigned in pair order so that results do not depend on hash ordering
+  std::vector<size_t> column(m_ * n_, npos);
+  full_index_.clear();
+  for (size_t f = 0; f < m_ * n_; ++f) {
+    if (supported[f]) {
+      column[f] = full_index_.size();
+      full_index_.emplace_back(f);
+    }
+  }
+
+  //! objective terms: w is symmetric, so keep a < b only and double the weight
+  terms_.clear();
+  terms_.reserve(weights_.size() / 2);
+  for (auto const & [key, w] : weights_) {
+    size_t const a = column[std::get<0>(key)*n_ + std::get<1>(key)];
+    size_t const b = column[std::get<2>(key)*n_ + std::get<3>(key)];
+    if (a < b) {
+      terms_.emplace_back(a, b, 2. * w);
+    }
+  }
+
+  //! conflicts: distinct candidates sharing a source point or a target point
+  std::vector<std::vector<size_t>> by_source(m_), by_target(n_);
+  for (size_t a = 0; a < full_index_.size(); ++a) {
+    by_source[full_index_[a] / n_].emplace_back(a);
+    by_target[full_index_[a] % n_].emplace_back(a);
+  }
+  conflicts_.clear();
+  auto add_conflicts = [&](std::vector<size_t> const & group) {
+    for (size_t p = 0; p < group.size(); ++p) {
+      for (size_t q = p + 1; q < group.size(); ++q) {
+        conflicts_.emplace_back(group[p], group[q]);
+      }
+    }
+  };
+  std::for_each(by_source.cbegin(), by_source.cend(), add_conflicts);
+  std::for_each(by_target.cbegin(), by_target.cend(), add_conflicts);
+  return;
+}
+
+/** SDP::lagrangian(V, grad)
+ * @brief evaluate the augmented Lagrangian and its gradient at factor V; matrix-free, cost is
+ * linear in the number of objective terms and constraints
+ *
+ * @param[in] V factor (rank x num_supported); column a is v_a without v_0
+ * @param[in][out] grad gradient with respect to V
+ * @return value of augmented Lagrangian
+ *
+ * @note L(V) = sum_ab w_ab <v_a, v_b> + sum_a (lambda_a h_a + rho/2 h_a^2)
+ *   + sum_(a,b) conflicting (mu_ab q_ab + rho/2 q_ab^2), with h_a = ||v_a||^2 - v_a(0) and
+ *   q_ab = <v_a, v_b>
+ */
+double cor::SDP::lagrangian(arma::mat const & V, arma::mat & grad) const noexcept {
+  size_t const r = V.n_rows;
+  grad.zeros(V.n_rows, V.n_cols);
+  double L = 0;
+
+  //! objective (w is nonpositive, so this is -<affinity, X>)
+  for (auto const & [a, b, w] : terms_) {
+    L += w * col_dot(V.colptr(a), V.colptr(b), r);
+    col_axpy(w, V.colptr(b), grad.colptr(a), r);
+    col_axpy(w, V.colptr(a), grad.colptr(b), r);
+  }
+
+  //! X_aa == x_a
+  for (size_t a = 0; a < V.n_cols; ++a) {
+    double const h = col_dot(V.colptr(a), V.colptr(a), r) - V(0, a);
+    double const c = lambda_(a) + rho_ * h;
+    L += lambda_(a) * h + 0.5 * rho_ * h * h;
+    col_axpy(2. * c, V.colptr(a), grad.colptr(a), r);
+    grad(0, a) -= c;
+  }
+
+  //! X_ab == 0 for conflicting candidates
+  for (size_t p = 0; p < conflicts_.size(); ++p) {
+    auto const & [a, b] = conflicts_[p];
+    double const q = col_dot(V.colptr(a), V.colptr(b), r);
+    double const c = mu_(p) + rho_ * q;
+    L += mu_(p) * q + 0.5 * rho_ * q * q;
+    col_axpy(c, V.colptr(b), grad.colptr(a), r);
+    col_axpy(c, V.colptr(a), grad.colptr(b), r);
+  }
+  return L;
+}
+
+/** SDP::max_violation(V)
+ * @brief largest absolute constraint violation at factor V
+ *
+ * @param[in] V factor (rank x num_supported)
+ * @return max over constraints of |h(V)|
+ */
+double cor::SDP::max_violation(arma::mat const & V) const noexcept {
+  size_t const r = V.n_rows;
+  double violation = 0;
+  for (size_t a = 0; a < V.n_cols; ++a) {
+    violation = std::max(violation,
+        std::abs(col_dot(V.colptr(a), V.colptr(a), r) - V(0, a)));
+  }
+  for (auto const & [a, b] : conflicts_) {
+    violation = std::max(violation, std::abs(col_dot(V.colptr(a), V.colptr(b), r)));
+  }
+  return violation;
+}
+
+/** SDP::calc_relaxation()
+ * @brief solve the low-rank relaxation with an augmented Lagrangian method; each subproblem
+ * is minimized by gradient descent with Barzilai-Borwein steps and backtracking
+ *
+ * @param[in]
+ * @return true if the constraint violation dropped below `Config::tol`, false otherwise
+ */
+bool cor::SDP::calc_relaxation() noexcept {
+  size_t const r = std::max(config_.rank, static_cast<size_t>(2));
+  size_t const N = full_index_.size();
+  if (N == 0) {
+    V_.reset();
+    return false;
+  }
+
+  //! initial factor: x_a = 1/2 with ||v_a||^2 == x_a and a random direction orthogonal to e_1
+  //! @note a local generator is used so that the global armadillo RNG is left untouched
+  std::mt19937 gen(config_.seed);
+  std::normal_distribution<double> normal(0., 1.);
+  V_.set_size(r, N);
+  for (size_t a = 0; a < N; ++a) {
+    for (size_t k = 1; k < r; ++k) {
+      V_(k, a) = normal(gen);
+    }
+    double const nrm = arma::norm(V_.col(a).tail(r - 1), 2);
+    V_.col(a).tail(r - 1) *= 0.5 / std::max(nrm, std::numeric_limits<double>::epsilon());
+    V_(0, a) = 0.5;
+  }
+
+  lambda_.zeros(N);
+  mu_.zeros(conflicts_.size());
+  rho_ = config_.rho;
+
+  //! workspace; sizes are fixed for the duration of the solve
+  arma::mat grad(r, N), V_next(r, N), grad_next(r, N);
+  double const grad_tol = 1e-2 * config_.tol;
+  double const min_step = 1e-12;
+  double violation = max_violation(V_);
+  for (size_t outer = 0; outer < config_.max_iter; ++outer) {
+    //! minimize augmented Lagrangian for fixed multipliers and penalty
+    double L = lagrangian(V_, grad);
+    double step = 1e-2;
+    for (size_t inner = 0; inner < config_.max_inner_iter; ++inner) {
+      double const grad_sq = arma::dot(grad, grad);
+      if (std::sqrt(grad_sq) < grad_tol) {
+        break;
+      }
+
+      //! backtracking (Armijo) line search from the current step
+      double L_next;
+      while (true) {
+        V_next = V_ - step * grad;
+        L_next = lagrangian(V_next, grad_next);
+        if (L_next <= L - 1e-4 * step * grad_sq || step < min_step) {
+          break;
+        }
+        step *= 0.5;
+      }
+
+      //! Barzilai-Borwein step for next iteration: <s, s> / <s, y>
+      double ss = 0, sy = 0;
+      for (size_t e = 0; e < V_.n_elem; ++e) {
+        double const s = V_next(e) - V_(e);
+        ss += s * s;
+        sy += s * (grad_next(e) - grad(e));
+      }
+      V_.swap(V_next);
+      grad.swap(grad_next);
+      L = L_next;
+      step = (sy > 0) ? ss / sy : 2. * step;
+    }
+
+    //! first-order multiplier update
+    for (size_t a = 0; a < N; ++a) {
+      lambda_(a) += rho_ * (col_dot(V_.colptr(a), V_.colptr(a), r) - V_(0, a));
+    }
+    for (size_t p = 0; p < conflicts_.size(); ++p) {
+      auto const & [a, b] = conflicts_[p];
+      mu_(p) += rho_ * col_dot(V_.colptr(a), V_.colptr(b), r);
+    }
+
+    double const next_violation = max_violation(V_);
+    if (next_violation < config_.tol) {
+      return true;
+    }
+    //! increase penalty only if feasibility is not improving fast enough
+    if (next_violation > 0.25 * violation) {
+      rho_ = std::min(10. * rho_, config_.rho_max);
+    }
+    violation = next_violation;
+  }
+  return false;
+}
+
+/** SDP::get_optimum()
+ * @brief get (relaxed) correspondence scores x_a = v_a(0) from the last relaxation solved
+ *
+ * @param[in]
+ * @return scores (length m*n, entry i*n + j for pair (i, j))
+ */
+arma::colvec cor::SDP::get_optimum() const noexcept {
+  arma::colvec x(m_ * n_, arma::fill::zeros);
+  if (V_.n_cols == full_index_.size()) {
+    for (size_t a = 0; a < full_index_.size(); ++a) {
+      x(full_index_[a]) = V_(0, a);
+    }
+  }
+  return x;
+}
+
+/** SDP::calc_correspondences()
+ * @brief identify pairwise correspondences between source and target set by rounding the
+ * solution of the relaxation
+ *
+ * @param[in][out] correspondences correspondences found; values are scores relative to the
+ * best pair
+ * @return
+ *
+ * @note the rounded solution is feasible even if the relaxation has not fully converged
+ */
+cor::status_e cor::SDP::calc_correspondences(cor::correspondences_t & correspondences) noexcept {
+  correspondences.clear();
+  if (full_index_.empty()) {
+    return status_e::failure;
+  }
+
+  calc_relaxation();
+  arma::colvec x = get_optimum();
+  double const x_max = x.max();
+  if (x_max <= std::numeric_limits<double>::epsilon()) {
+    return status_e::failure;  // LCOV_EXCL_LINE
+  }
+
+  //! scale so that the best pair has score 1, then discretize under one-to-one constraint
+  x /= x_max;
+  greedy_assignment(x, m_, n_, std::numeric_limits<size_t>::max(),
+      config_.corr_threshold - std::numeric_limits<double>::epsilon(), correspondences);
+  return status_e::success;
+}
@@ -0,0 +1,104 @@
+#pragma once
+//! c/c++ headers
+//! dependency headers
+#include <armadillo>
+#include <nlohmann/json.hpp>
+//! project headers
+#include "correspondences/common/base.hpp"
+#include "correspondences/common/types.hpp"
+#include "correspondences/common/utilities.hpp"
+
+namespace correspondences {
+namespace sm {
+
+/** @struct Config : CorrespondencesConfigBase
+ * @var Config::corr_threshold
+ * minimum score (relative to the best-scoring pair) to accept a correspondence {\in (0, 1]}
+ * @var Config::max_iter
+ * maximum number of power iterations
+ * @var Config::tol
+ * convergence tolerance for power iteration
+ */
+struct Config : CorrespondencesConfigBase {
+  Config()
+    : CorrespondencesConfigBase() {
+      set_defaults();
+    }
+
+  explicit Config(nlohmann::json & config) :
+    CorrespondencesConfigBase(config) {
+      set_defaults();
+      json_utils::check_for_param(config, "corr_threshold", corr_threshold);
+      json_utils::check_for_param(config, "max_iter", max_iter);
+      json_utils::check_for_param(config, "tol", tol);
+    }
+
+  void set_defaults() noexcept final {
+    corr_threshold = 0.5;
+    max_iter = 100;
+    tol = 1e-6;
+  }
+
+  double corr_threshold;
+  size_t max_iter;
+  double tol;
+};
+}  // namespace sm
+
+/** @class SM : public CorrespondencesBase
+ * @brief wrapper class definition for correspondence calculation by spectral matching: the
+ * leading eigenvector of the pairwise consistency affinity matrix, discretized greedily
+ *
+ * @see Leordeanu and Hebert, "A Spectral Technique for Correspondence Problems Using Pairwise
+ * Constraints", ICCV 2005
+ */
+class SM : public CorrespondencesBase {
+ public:
+   /** SM::SM(source_pts, target_pts, config)
+    * @brief constructor for spectral matching wrapper class
+    *
+    * @param[in] source_pts distribution of (columnar) source points
+    * @param[in] target_pts distribution of (columnar) target points
+    * @param[in] config `Config` instance with algorithm parameters; see `Config` definition
+    * @return
+    */
+   explicit SM(arma::mat const & source_pts,
+       arma::mat const & target_pts, sm::Config config)
+     : config_(config)
+     , weights_(generate_weight_tensor(source_pts, target_pts,
+         config_.epsilon, config_.pairwise_dist_threshold))
+     , m_(source_pts.n_cols)
+     , n_(target_pts.n_cols) { }
+
+   /** SM::~SM()
+    * @brief destructor for spectral matching wrapper class
+    *
+    * @param[in]
+    * @return
+    */
+   ~SM();
+
+   /** SM::calc_correspondences()
+    * @brief identify pairwise correspondences between source and target set from the leading
+    * eigenvector of the affinity matrix
+    *
+    * @param[in][out] corr correspondences found; values are scores relative to the best pair
+    * @return solution status
+    * @see status_e definition in types.hpp
+    */
+   status_e calc_correspondences(correspondences_t & corr) noexcept final;
+
+   /** SM::num_consistent_pairs()
+    * @brief get identified correspondences
+    *
+    * @param[in]
+    * @return number of pairwise consistencies identified
+    */
+   size_t num_consistent_pairs() const noexcept { return weights_.size(); }
+
+ private:
+   sm::Config config_;  //! initialization data struct
+   WeightTensor weights_;  //! pairwise consistencies (sparse affinity matrix)
+   size_t m_, n_;  //! no. of source and target points
+};
+}  // namespace correspondences
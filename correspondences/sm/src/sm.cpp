@@ -0,0 +1,44 @@
+//! c/c++ headers
+#include <limits>
+//! dependency headers
+//! project headers
+#include "correspondences/sm/sm.hpp"
+
+//! namespaces
+namespace cor = correspondences;
+
+// LCOV_EXCL_START
+/** SM::~SM()
+ * @brief destructor for spectral matching wrapper class
+ *
+ * @param[in]
+ * @return
+ *
+ * @note nothing to do; resources are automatically deleted
+ */
+cor::SM::~SM() { }
+// LCOV_EXCL_STOP
+
+/** SM::calc_correspondences()
+ * @brief identify pairwise correspondences between source and target set from the leading
+ * eigenvector of the affinity matrix
+ *
+ * @param[in][out] correspondences correspondences found; values are scores relative to the
+ * best pair
+ * @return
+ */
+cor::status_e cor::SM::calc_correspondences(cor::correspondences_t & correspondences) noexcept {
+  correspondences.clear();
+
+  //! leading eigenvector of affinity matrix; cost is linear in the no. of consistent pairs
+  arma::colvec x;
+  if (!leading_eigenvector(weights_, m_, n_, config_.max_iter, config_.tol, x)) {
+    return status_e::failure;
+  }
+
+  //! scale so that the best pair has score 1, then discretize under one-to-one constraint
+  x /= x.max();
+  greedy_assignment(x, m_, n_, std::numeric_limits<size_t>::max(),
+      config_.corr_threshold - std::numeric_limits<double>::epsilon(), correspondences);
+  return status_e::success;
+}
@@ -1,8 +1,11 @@
 #pragma once
 //! c/c++ headers
 #include <string>
+#include <vector>
 //! dependency headers
 //! project headers
+#include "transforms/common/inlier_oracle.hpp"
+#include "transforms/common/voxel_hash.hpp"
 #include "transforms/icp/icp.hpp"  // for KDTreeSearcher definition
 #include "types.hpp"
 
@@ -18,6 +21,64 @@ namespace nmsac {
 size_t count_correspondences(arma::mat const & src, transforms::KDTreeSearcher & tgt_tree,
     double const & epsilon) noexcept;
 
+/**
+ * @brief Count correspondences between two sets of points using a parallel exact searcher
+ *
+ * @param [in] src source points
+ * @param [in] tgt_searcher target points (as a parallel nearest-neighbor searcher)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ */
+size_t count_correspondences(arma::mat const & src,
+    transforms::ParallelSearcher const & tgt_searcher, double const & epsilon) noexcept;
+
+/**
+ * @brief Count correspondences between two sets of points using a fixed-radius index
+ *
+ * @param [in] src source points
+ * @param [in] tgt_voxels target points (as a voxel index built with radius >= epsilon)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ */
+size_t count_correspondences(arma::mat const & src, transforms::VoxelHash const & tgt_voxels,
+    double const & epsilon) noexcept;
+
+/**
+ * @brief Count correspondences between two sets of points using a precomputed inlier oracle
+ *
+ * @param [in] src source points
+ * @param [in] tgt_oracle target points (as an inlier oracle built with the same epsilon)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ */
+size_t count_correspondences(arma::mat const & src, transforms::InlierOracle const & tgt_oracle,
+    double const & epsilon) noexcept;
+
+/**
+ * @brief Count correspondences between rigidly transformed source points and target points using a
+ * precomputed inlier oracle, without forming the transformed source points
+ *
+ * @param [in] src source points
+ * @param [in] R rotation applied to source points
+ * @param [in] t translation applied to source points (after rotation)
+ * @param [in] tgt_oracle target points (as an inlier oracle built with the same epsilon)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ */
+size_t count_correspondences(arma::mat const & src, arma::mat33 const & R, arma::vec3 const & t,
+    transforms::InlierOracle const & tgt_oracle, double const & epsilon) noexcept;
+
+/**
+ * @brief Copy of a point cloud with its points sorted along a Morton (z-order) curve, so that
+ * points close in memory are mostly close in space
+ *
+ * @param [in] pts points (columnar, 3 rows)
+ * @param [in][out] order (optional) column of `pts` that each column of the copy came from
+ * @return sorted copy of `pts` (in the input order, with the identity order, if `pts` cannot be
+ * sorted; see `transforms::morton_order`)
+ */
+arma::mat morton_reorder(arma::mat const & pts, std::vector<size_t> * order = nullptr) noexcept;
+
 void to_homog(arma::mat33 const & R, arma::vec3 const & t, arma::mat44 & H) noexcept;
 void from_homog(arma::mat33 & R, arma::vec3 & t, arma::mat44 const & H) noexcept;
 }  // end namespace nmsac
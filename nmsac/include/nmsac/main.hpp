@@ -18,7 +18,7 @@ namespace nmsac {
  * @param [in][out] iter number of iterations
  * @return
  */
-bool main(arma::mat src_pts, arma::mat tgt_pts, nlohmann::json & json_config,
+bool main(arma::mat const & src_pts, arma::mat const & tgt_pts, nlohmann::json & json_config,
     arma::mat33 & optimal_rot, arma::vec3 & optimal_trans,
     size_t & max_inliers, size_t & iter) noexcept;
 }  // namespace nmsac
@@ -13,11 +13,16 @@
 #include "correspondences/graph/graph.hpp"
 #include "correspondences/qap/qap.hpp"
 #include "correspondences/mc/mc.hpp"
+#include "correspondences/sm/sm.hpp"
+#include "correspondences/sdp/sdp.hpp"
+#include "transforms/icp/icp.hpp"
 
 namespace nmsac {
 enum class algorithms_e {
   qap = 0,
-  mc = 1
+  mc = 1,
+  sm = 2,
+  sdp = 3
 };
 
 struct Config {
@@ -34,6 +39,20 @@ struct Config {
     key_val["max_iter_icp"] = std::to_string(max_iter_icp);
     key_val["tol_icp"] = double_prec_str(tol_icp, 3);
     key_val["outlier_rej_icp"] = double_prec_str(outlier_rej_icp, 3);
+    key_val["icp_method"] = std::to_string(static_cast<int>(icp_method));
+    key_val["icp_normal_neighbors"] = std::to_string(icp_normal_neighbors);
+    key_val["icp_covariance_epsilon"] = double_prec_str(icp_covariance_epsilon, 3);
+    key_val["icp_anderson_depth"] = std::to_string(icp_anderson_depth);
+    key_val["icp_coarse_fraction"] = double_prec_str(icp_coarse_fraction, 3);
+    key_val["icp_coarse_growth"] = double_prec_str(icp_coarse_growth, 3);
+    key_val["icp_coarse_tolerance"] = double_prec_str(icp_coarse_tolerance, 3);
+    key_val["icp_nn_epsilon"] = double_prec_str(icp_nn_epsilon, 3);
+    key_val["icp_max_correspondence_distance"] =
+      double_prec_str(icp_max_correspondence_distance, 3);
+    key_val["icp_nn_cache_size"] = std::to_string(icp_nn_cache_size);
+    key_val["icp_abort_after"] = std::to_string(icp_abort_after);
+    key_val["icp_abort_heuristic_margin"] = double_prec_str(icp_abort_heuristic_margin, 3);
+    key_val["morton_order"] = morton_order ? "true" : "false";
     json empty = {};
     setup_algorithm(empty);
   }
@@ -69,6 +88,35 @@ struct Config {
     key_val["tol_icp"] = double_prec_str(tol_icp, 3);
     json_utils::check_for_param(nmsac_config, "outlier_rej_icp", outlier_rej_icp);
     key_val["outlier_rej_icp"] = double_prec_str(outlier_rej_icp, 3);
+    json_utils::check_for_param(nmsac_config, "icp_method", icp_method);
+    key_val["icp_method"] = std::to_string(static_cast<int>(icp_method));
+    json_utils::check_for_param(nmsac_config, "icp_normal_neighbors", icp_normal_neighbors);
+    key_val["icp_normal_neighbors"] = std::to_string(icp_normal_neighbors);
+    json_utils::check_for_param(nmsac_config, "icp_covariance_epsilon", icp_covariance_epsilon);
+    key_val["icp_covariance_epsilon"] = double_prec_str(icp_covariance_epsilon, 3);
+    json_utils::check_for_param(nmsac_config, "icp_anderson_depth", icp_anderson_depth);
+    key_val["icp_anderson_depth"] = std::to_string(icp_anderson_depth);
+    json_utils::check_for_param(nmsac_config, "icp_coarse_fraction", icp_coarse_fraction);
+    key_val["icp_coarse_fraction"] = double_prec_str(icp_coarse_fraction, 3);
+    json_utils::check_for_param(nmsac_config, "icp_coarse_growth", icp_coarse_growth);
+    key_val["icp_coarse_growth"] = double_prec_str(icp_coarse_growth, 3);
+    json_utils::check_for_param(nmsac_config, "icp_coarse_tolerance", icp_coarse_tolerance);
+    key_val["icp_coarse_tolerance"] = double_prec_str(icp_coarse_tolerance, 3);
+    json_utils::check_for_param(nmsac_config, "icp_nn_epsilon", icp_nn_epsilon);
+    key_val["icp_nn_epsilon"] = double_prec_str(icp_nn_epsilon, 3);
+    json_utils::check_for_param(nmsac_config, "icp_max_correspondence_distance",
+        icp_max_correspondence_distance);
+    key_val["icp_max_correspondence_distance"] =
+      double_prec_str(icp_max_correspondence_distance, 3);
+    json_utils::check_for_param(nmsac_config, "icp_nn_cache_size", icp_nn_cache_size);
+    key_val["icp_nn_cache_size"] = std::to_string(icp_nn_cache_size);
+    json_utils::check_for_param(nmsac_config, "icp_abort_after", icp_abort_after);
+    key_val["icp_abort_after"] = std::to_string(icp_abort_after);
+    json_utils::check_for_param(nmsac_config, "icp_abort_heuristic_margin",
+        icp_abort_heuristic_margin);
+    key_val["icp_abort_heuristic_margin"] = double_prec_str(icp_abort_heuristic_margin, 3);
+    json_utils::check_for_param(nmsac_config, "morton_order", morton_order);
+    key_val["morton_order"] = morton_order ? "true" : "false";
     setup_algorithm(nmsac_config);
   }
 
@@ -85,6 +133,8 @@ struct Config {
       key_val["algo_config::n_pair_threshold"] = std::to_string(
           derived_ptr->n_pair_threshold);
       key_val["algo_config::min_corr"] = std::to_string(derived_ptr->min_corr);
+      key_val["algo_config::initialization"] = std::to_string(
+          static_cast<int>(derived_ptr->init));
       algo_config = std::static_pointer_cast<correspondences::CorrespondencesConfigBase>(derived_ptr);  // NOLINT [linelength]
     } else if (config.find("mc") != config.end()) {
       algorithm = algorithms_e::mc;
@@ -97,6 +147,33 @@ struct Config {
         (derived_ptr->algo == correspondences::graph::max_clique_algo_e::bnb_basic)
         ? "bnb_basic" : "bnb_color";
       algo_config = std::static_pointer_cast<correspondences::CorrespondencesConfigBase>(derived_ptr);  // NOLINT [linelength]
+    } else if (config.find("sm") != config.end()) {
+      algorithm = algorithms_e::sm;
+      auto derived_ptr = std::make_shared<correspondences::sm::Config>(config["sm"]);
+      key_val["algorithm"] = "sm";
+      key_val["algo_config::epsilon"] = double_prec_str(derived_ptr->epsilon, 3);
+      key_val["algo_config::pairwise_dist_threshold"] =
+        double_prec_str(derived_ptr->pairwise_dist_threshold, 3);
+      key_val["algo_config::corr_threshold"] = double_prec_str(derived_ptr->corr_threshold, 3);
+      key_val["algo_config::max_iter"] = std::to_string(derived_ptr->max_iter);
+      key_val["algo_config::tol"] = double_prec_str(derived_ptr->tol, 3);
+      algo_config = std::static_pointer_cast<correspondences::CorrespondencesConfigBase>(derived_ptr);  // NOLINT [linelength]
+    } else if (config.find("sdp") != config.end()) {
+      algorithm = algorithms_e::sdp;
+      auto derived_ptr = std::make_shared<correspondences::sdp::Config>(config["sdp"]);
+      key_val["algorithm"] = "sdp";
+      key_val["algo_config::epsilon"] = double_prec_str(derived_ptr->epsilon, 3);
+      key_val["algo_config::pairwise_dist_threshold"] =
+        double_prec_str(derived_ptr->pairwise_dist_threshold, 3);
+      key_val["algo_config::rank"] = std::to_string(derived_ptr->rank);
+      key_val["algo_config::max_iter"] = std::to_string(derived_ptr->max_iter);
+      key_val["algo_config::max_inner_iter"] = std::to_string(derived_ptr->max_inner_iter);
+      key_val["algo_config::rho"] = double_prec_str(derived_ptr->rho, 3);
+      key_val["algo_config::rho_max"] = double_prec_str(derived_ptr->rho_max, 3);
+      key_val["algo_config::tol"] = double_prec_str(derived_ptr->tol, 3);
+      key_val["algo_config::corr_threshold"] = double_prec_str(derived_ptr->corr_threshold, 3);
+      key_val["algo_config::seed"] = std::to_string(derived_ptr->seed);
+      algo_config = std::static_pointer_cast<correspondences::CorrespondencesConfigBase>(derived_ptr);  // NOLINT [linelength]
     } else {
       algorithm = algorithms_e::qap;
       auto derived_ptr = std::make_shared<correspondences::qap::Config>();
@@ -107,6 +184,8 @@ struct Config {
       key_val["algo_config::corr_threshold"] = double_prec_str(derived_ptr->corr_threshold, 3);
       key_val["algo_config::n_pair_threshold"] = std::to_string(derived_ptr->n_pair_threshold);
       key_val["algo_config::min_corr"] = std::to_string(derived_ptr->min_corr);
+      key_val["algo_config::initialization"] = std::to_string(
+          static_cast<int>(derived_ptr->init));
       algo_config = std::static_pointer_cast<correspondences::CorrespondencesConfigBase>(derived_ptr);  // NOLINT [linelength]
     }
     return;
@@ -123,6 +202,19 @@ struct Config {
     max_iter_icp = 100;
     tol_icp = 1e-8;
     outlier_rej_icp = 0.2;
+    icp_method = transforms::icp_method_e::point_to_point;
+    icp_normal_neighbors = 10;
+    icp_covariance_epsilon = 1e-3;
+    icp_anderson_depth = 0;
+    icp_coarse_fraction = 1;
+    icp_coarse_growth = 4;
+    icp_coarse_tolerance = 5e-2;
+    icp_nn_epsilon = 0;
+    icp_max_correspondence_distance = 0;
+    icp_nn_cache_size = 4;
+    icp_abort_after = 0;
+    icp_abort_heuristic_margin = 2;
+    morton_order = false;
     algorithm = algorithms_e::qap;
     algo_config = std::make_shared<correspondences::CorrespondencesConfigBase>();
   }
@@ -138,6 +230,19 @@ struct Config {
   size_t max_iter_icp;
   double tol_icp;
   double outlier_rej_icp;
+  transforms::icp_method_e icp_method;
+  size_t icp_normal_neighbors;
+  double icp_covariance_epsilon;
+  size_t icp_anderson_depth;
+  double icp_coarse_fraction;
+  double icp_coarse_growth;
+  double icp_coarse_tolerance;
+  double icp_nn_epsilon;
+  double icp_max_correspondence_distance;
+  size_t icp_nn_cache_size;
+  size_t icp_abort_after;
+  double icp_abort_heuristic_margin;
+  bool morton_order;
   algorithms_e algorithm;
   std::shared_ptr<correspondences::CorrespondencesConfigBase> algo_config;
   std::map<std::string, std::string> key_val;
@@ -1,4 +1,5 @@
 //! c/c++ headers
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -43,6 +44,133 @@ size_t nmsac::count_correspondences(arma::mat const & src, xfrm::KDTreeSearcher
   return idx_inliers.n_elem;
 }
 
+/**
+ * @brief Count correspondences between two sets of points using a parallel exact searcher
+ *
+ * @param [in] src source points
+ * @param [in] tgt_searcher target points (as a parallel nearest-neighbor searcher)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ *
+ * @note source points are searched in blocks on all threads; the const searcher can be shared
+ */
+size_t nmsac::count_correspondences(arma::mat const & src,
+    xfrm::ParallelSearcher const & tgt_searcher, double const & epsilon) noexcept {
+  // LCOV_EXCL_START
+  //! if epsilon <= 0, return NaN
+  if (epsilon < std::numeric_limits<double>::epsilon()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Third argument must be a positive number." << std::endl;
+    return std::numeric_limits<size_t>::quiet_NaN();
+  }
+  // LCOV_EXCL_STOP
+
+  //! perform nearest neighbor search
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  tgt_searcher.search(src, neighbors, distances);
+
+  //! the no. of correspondences is the no. of nearest neighbor distances within threshold
+  return arma::accu(distances <= epsilon);
+}
+
+/**
+ * @brief Count correspondences between two sets of points using a fixed-radius index
+ *
+ * @param [in] src source points
+ * @param [in] tgt_voxels target points (as a voxel index built with radius >= epsilon)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ *
+ * @note only asks whether any target point is within epsilon, so the scan of a query's
+ * neighborhood stops at the first such point
+ */
+size_t nmsac::count_correspondences(arma::mat const & src, xfrm::VoxelHash const & tgt_voxels,
+    double const & epsilon) noexcept {
+  // LCOV_EXCL_START
+  //! if epsilon <= 0 or beyond the radius of the index, return NaN
+  if (epsilon < std::numeric_limits<double>::epsilon() || epsilon > tgt_voxels.radius()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Third argument must be a positive number no larger than the index radius." << std::endl;
+    return std::numeric_limits<size_t>::quiet_NaN();
+  }
+  // LCOV_EXCL_STOP
+
+  return tgt_voxels.count_within(src, epsilon);
+}
+
+/**
+ * @brief Count correspondences between two sets of points using a precomputed inlier oracle
+ *
+ * @param [in] src source points
+ * @param [in] tgt_oracle target points (as an inlier oracle built with the same epsilon)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ *
+ * @note costs one hash probe per source point, plus an exact check against a few target points
+ * for source points near the boundary of the epsilon-neighborhood of the target
+ */
+size_t nmsac::count_correspondences(arma::mat const & src, xfrm::InlierOracle const & tgt_oracle,
+    double const & epsilon) noexcept {
+  // LCOV_EXCL_START
+  //! if epsilon differs from the one the oracle was built for, return NaN
+  if (epsilon != tgt_oracle.epsilon()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Third argument must match the epsilon the oracle was built for." << std::endl;
+    return std::numeric_limits<size_t>::quiet_NaN();
+  }
+  // LCOV_EXCL_STOP
+
+  return tgt_oracle.count_inliers(src);
+}
+
+/**
+ * @brief Count correspondences between rigidly transformed source points and target points using a
+ * precomputed inlier oracle, without forming the transformed source points
+ *
+ * @param [in] src source points
+ * @param [in] R rotation applied to source points
+ * @param [in] t translation applied to source points (after rotation)
+ * @param [in] tgt_oracle target points (as an inlier oracle built with the same epsilon)
+ * @param [in] epsilon threshold for correspondence counting
+ * @return number of correspondences found
+ */
+size_t nmsac::count_correspondences(arma::mat const & src, arma::mat33 const & R,
+    arma::vec3 const & t, xfrm::InlierOracle const & tgt_oracle, double const & epsilon) noexcept {
+  // LCOV_EXCL_START
+  //! if epsilon differs from the one the oracle was built for, return NaN
+  if (epsilon != tgt_oracle.epsilon()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Fifth argument must match the epsilon the oracle was built for." << std::endl;
+    return std::numeric_limits<size_t>::quiet_NaN();
+  }
+  // LCOV_EXCL_STOP
+
+  return tgt_oracle.count_inliers(R, t, src);
+}
+
+/**
+ * @brief Copy of a point cloud with its points sorted along a Morton (z-order) curve, so that
+ * points close in memory are mostly close in space
+ *
+ * @param [in] pts points (columnar, 3 rows)
+ * @param [in][out] order (optional) column of `pts` that each column of the copy came from
+ * @return sorted copy of `pts` (in the input order, with the identity order, if `pts` cannot be
+ * sorted; see `transforms::morton_order`)
+ */
+arma::mat nmsac::morton_reorder(arma::mat const & pts, std::vector<size_t> * order) noexcept {
+  std::vector<size_t> local_order;
+  std::vector<size_t> & perm = (order != nullptr) ? *order : local_order;
+  xfrm::morton_order(pts, perm);
+  arma::mat sorted(pts.n_rows, pts.n_cols);
+  int64_t const n = static_cast<int64_t>(pts.n_cols);
+  #pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < n; ++i) {
+    sorted.col(i) = pts.col(perm[i]);
+  }
+  return sorted;
+}
+
 void nmsac::to_homog(arma::mat33 const & R, arma::vec3 const & t, arma::mat44 & H) noexcept {
   H.eye();
   H( arma::span(0, 2), arma::span(0, 2) ) = R;
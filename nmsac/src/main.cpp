@@ -25,7 +25,7 @@ namespace xfrm = transforms;
  * @param [in][out] iter number of iterations
  * @return
  */
-bool nmsac::main(arma::mat src_pts, arma::mat tgt_pts, nlohmann::json & json_config,
+bool nmsac::main(arma::mat const & src_pts, arma::mat const & tgt_pts, nlohmann::json & json_config,
     arma::mat33 & optimal_rot, arma::vec3 & optimal_trans,
     size_t & max_inliers, size_t & iter) noexcept {
   // LCOV_EXCL_START
@@ -41,9 +41,12 @@ bool nmsac::main(arma::mat src_pts, arma::mat tgt_pts, nlohmann::json & json_con
   }
   // LCOV_EXCL_STOP
 
-  //! make a copy of src_pts and tgt_pts
-  arma::mat const src_pts_orig = src_pts;
-  arma::mat const tgt_pts_orig = tgt_pts;
+  //! the inputs are only read; sampling removes sampled columns from working copies instead:
+  //! `src_remaining` for the whole run, `tgt_remaining` refilled before each set of inner passes
+  arma::mat const & src_pts_orig = src_pts;
+  arma::mat const & tgt_pts_orig = tgt_pts;
+  arma::mat src_remaining = src_pts;
+  arma::mat tgt_remaining;
 
   //! read config data
   Config config(json_config);
@@ -51,6 +54,19 @@ bool nmsac::main(arma::mat src_pts, arma::mat tgt_pts, nlohmann::json & json_con
   std::cout << config << std::endl;
   config.print_status = true;
 
+  //! clouds for icp and inlier counting: with `morton_order`, copies sorted along a Morton curve,
+  //! so that kd-tree builds, batched nearest-neighbor queries and gathers walk memory mostly in
+  //! order.  Sampling still draws from the input order, so a given seed picks the same samples
+  //! either way, and the outputs (transformation and inlier count) are equivalent up to ties and
+  //! the coarse-to-fine subset: nearest-neighbor ties and the fixed-seed shuffle of icp's coarse
+  //! subsets both depend on the order of the points
+  arma::mat const src_pts_sorted = config.morton_order ? morton_reorder(src_pts_orig) :
+    arma::mat();
+  arma::mat const tgt_pts_sorted = config.morton_order ? morton_reorder(tgt_pts_orig) :
+    arma::mat();
+  arma::mat const & src_cloud = config.morton_order ? src_pts_sorted : src_pts_orig;
+  arma::mat const & tgt_cloud = config.morton_order ? tgt_pts_sorted : tgt_pts_orig;
+
   //! initializations
   auto const & n = config.points_per_sample;
 
@@ -61,25 +77,69 @@ bool nmsac::main(arma::mat src_pts, arma::mat tgt_pts, nlohmann::json & json_con
   //! for repeatable sampling
   arma::arma_rng::set_seed(config.random_seed);
 
-  //! setup KDTreeSearcher for finding nearest-neighbor points between
-  //! transformed source and target point clouds
-  xfrm::KDTreeSearcher tgt_tree( tgt_pts_orig );
+  //! setup icp target once: kd-tree for finding nearest-neighbor points between
+  //! transformed source and target point clouds (and target normals, if needed)
+  xfrm::ICPConfig icp_config;
+  icp_config.max_its = config.max_iter_icp;
+  icp_config.tolerance = config.tol_icp;
+  icp_config.reject_ratio = config.outlier_rej_icp;
+  icp_config.method = config.icp_method;
+  icp_config.normal_neighbors = config.icp_normal_neighbors;
+  icp_config.covariance_epsilon = config.icp_covariance_epsilon;
+  icp_config.anderson_depth = config.icp_anderson_depth;
+  icp_config.coarse_fraction = config.icp_coarse_fraction;
+  icp_config.coarse_growth = config.icp_coarse_growth;
+  icp_config.coarse_tolerance = config.icp_coarse_tolerance;
+  icp_config.coarse_seed = config.random_seed;
+  icp_config.nn_epsilon = config.icp_nn_epsilon;
+  icp_config.max_correspondence_distance = config.icp_max_correspondence_distance;
+  icp_config.nn_cache_size = config.icp_nn_cache_size;
+  //! early abort (if enabled; a lossy heuristic): a hypothesis whose inlier count, after
+  //! `icp_abort_after` iterations, could not beat the best so far even if it grew by
+  //! `icp_abort_heuristic_margin` is dropped
+  if (config.icp_abort_after > 0) {
+    icp_config.abort_epsilon = config.algo_config->epsilon;
+    icp_config.abort_after = config.icp_abort_after;
+    icp_config.abort_heuristic_margin = config.icp_abort_heuristic_margin;
+  }
+  size_t icp_aborted = 0;
+  //! a converged icp run counts inliers from its last (exact) nearest-neighbor distances
+  icp_config.inlier_epsilon = config.algo_config->epsilon;
+  xfrm::ICPTarget icp_target(tgt_cloud, icp_config);
+
+  //! inlier oracle for counting inliers when icp's matches are approximate: only "is there a
+  //! target point within epsilon" is asked of the target, so precompute the answer over a sparse
+  //! grid once and score each hypothesis with one hash probe per source point
+  auto const & epsilon = config.algo_config->epsilon;
+  bool const icp_counts_inliers = (icp_config.nn_epsilon == 0 &&
+      (icp_config.max_correspondence_distance <= 0 ||
+       icp_config.max_correspondence_distance >= epsilon));
+  xfrm::InlierOracle const inlier_oracle = icp_counts_inliers ? xfrm::InlierOracle() :
+    xfrm::InlierOracle(tgt_cloud, epsilon);
+
+  //! source covariances for generalized icp do not depend on the hypothesis: compute them once
+  arma::cube src_covs;
+  if (icp_config.method == xfrm::icp_method_e::gicp) {
+    xfrm::ParallelSearcher const src_tree(src_cloud);
+    xfrm::estimate_covariances(src_cloud, src_tree, icp_config.normal_neighbors,
+        icp_config.covariance_epsilon, src_covs);
+  }
 
   //! outer loop
   bool stop = false;
   auto Tmax = std::numeric_limits<double>::max();
   while (!stop && iter < config.max_iter) {
-    arma::mat const src_smpl = sample_cols(src_pts, n);
-    //! reset tgt_pts back to original for next set of inner passes
-    tgt_pts = tgt_pts_orig;
+    arma::mat const src_smpl = sample_cols(src_remaining, n);
+    //! reset tgt_remaining back to original for next set of inner passes
+    tgt_remaining = tgt_pts_orig;
 
-    while (tgt_pts.n_cols > 2*n) {  // XXX(jwd): re-eval what this condition should be
-      arma::mat const tgt_smpl = sample_cols(tgt_pts, n);
+    while (tgt_remaining.n_cols > 2*n) {  // XXX(jwd): re-eval what this condition should be
+      arma::mat const tgt_smpl = sample_cols(tgt_remaining, n);
 
       // LCOV_EXCL_START
       if (config.print_status) {
         std::cout << "Remaining target points to sample from: " <<
-          tgt_pts.n_cols << std::endl;
+          tgt_remaining.n_cols << std::endl;
       }
       // LCOV_EXCL_STOP
 
@@ -94,50 +154,76 @@ bool nmsac::main(arma::mat src_pts, arma::mat tgt_pts, nlohmann::json & json_con
           arma::mat44 H_nmr;
           to_homog(R_nmr, t_nmr, H_nmr);
           arma::mat44 H_icp;
-          if (!xfrm::iterative_closest_point(src_pts_orig, tgt_pts_orig, H_nmr,
-                config.max_iter_icp, config.tol_icp, config.outlier_rej_icp, H_icp)) {
+          xfrm::ICPStats icp_stats;
+          icp_config.abort_min_inliers = max_inliers + 1;
+          bool const icp_converged = (icp_config.method == xfrm::icp_method_e::gicp)
+            ? xfrm::generalized_icp(src_cloud, src_covs, icp_target, H_nmr, icp_config, H_icp,
+                &icp_stats)
+            : xfrm::iterative_closest_point(src_cloud, icp_target, H_nmr, icp_config, H_icp,
+                &icp_stats);
+
+          // LCOV_EXCL_START
+          if (config.print_status) {
+            std::cout << "ICP iterations: " << icp_stats.iterations <<
+              ", nearest-neighbor queries: " << icp_stats.nn_queries <<
+              " (kd-tree searches: " << icp_stats.nn_tree_searches << ")" << std::endl;
+          }
+          // LCOV_EXCL_STOP
+
+          if (icp_stats.aborted) {
+            //! could not beat the best hypothesis so far: the hypothesis was still drawn and
+            //! scored (well enough to reject it), so it counts toward the stopping rule
+            ++icp_aborted;
+            ++iter;
+          } else if (!icp_converged) {
             std::cout << static_cast<std::string>(__func__) <<
               ": iterative_closest_point failed." << std::endl;
             continue;
-          }
-
-          //! decompose H into rotation, R, and translation, t, components
-          arma::mat33 R_icp;
-          arma::vec3 t_icp;
-          from_homog(R_icp, t_icp, H_icp);
-
-          //! transform source points onto target points and count the number of inliers
-          arma::mat const src_pts_orig_xform = R_icp * src_pts_orig +
-            arma::repmat(t_icp, 1, src_pts_orig.n_cols);
-          auto const num_inliers = count_correspondences(src_pts_orig_xform,
-              tgt_tree, config.algo_config->epsilon);
-
-          //! increase iteration count
-          ++iter;
-
-          //! check if the current fit is better than previous fits
-          if (num_inliers > max_inliers) {
-            max_inliers = num_inliers;
-            optimal_rot = R_icp;
-            optimal_trans = t_icp;
-            // LCOV_EXCL_START
-            if (config.print_status) {
-              std::cout << "////////////////////////////////" << std::endl;
-              std::cout << "Best so-far consensus size: " << max_inliers << std::endl;
-              std::cout << "////////////////////////////////" << std::endl;
+          } else {
+            //! decompose H into rotation, R, and translation, t, components
+            arma::mat33 R_icp;
+            arma::vec3 t_icp;
+            from_homog(R_icp, t_icp, H_icp);
+
+            //! count the number of inliers of the source points transformed onto the target
+            //! points: reuse icp's count if its last matches were exact, otherwise ask the oracle
+            //! (the transformation is applied on the fly, point by point)
+            auto const num_inliers = icp_stats.counted_inliers ? icp_stats.inliers :
+              count_correspondences(src_cloud, R_icp, t_icp, inlier_oracle,
+                  config.algo_config->epsilon);
+
+            //! increase iteration count
+            ++iter;
+
+            //! check if the current fit is better than previous fits
+            if (num_inliers > max_inliers) {
+              max_inliers = num_inliers;
+              optimal_rot = R_icp;
+              optimal_trans = t_icp;
+              // LCOV_EXCL_START
+              if (config.print_status) {
+                std::cout << "////////////////////////////////" << std::endl;
+                std::cout << "Best so-far consensus size: " << max_inliers << std::endl;
+                std::cout << "////////////////////////////////" << std::endl;
+              }
+              // LCOV_EXCL_STOP
+              //! compute stopping criteria
+              auto const prob_I = static_cast<double>(max_inliers) /
+                static_cast<double>(src_pts_orig.n_cols);
+              Tmax = std::log(1. - config.ps) / std::log(1. - std::pow(prob_I, config.k));
             }
-            // LCOV_EXCL_STOP
-            //! compute stopping criteria
-            auto const prob_I = static_cast<double>(max_inliers) /
-              static_cast<double>(src_pts_orig.n_cols);
-            Tmax = std::log(1. - config.ps) / std::log(1. - std::pow(prob_I, config.k));
           }
       } else {
         //! solver failed, go to next iteration
         continue;
       }
 
-      if (iter >= static_cast<size_t>(Tmax)) {
+      if (iter >= config.max_iter) {
+        //! iteration budget spent (checked here too, since one set of inner passes can run many
+        //! iterations)
+        stop = true;
+        break;
+      } else if (iter >= static_cast<size_t>(Tmax)) {
         // LCOV_EXCL_START
         if (config.print_status) {
           std::cout << "Algorithm converged.  Exiting..." << std::endl;
@@ -148,5 +234,11 @@ bool nmsac::main(arma::mat src_pts, arma::mat tgt_pts, nlohmann::json & json_con
       }
     }
   }
+
+  // LCOV_EXCL_START
+  if (config.print_status && config.icp_abort_after > 0) {
+    std::cout << "ICP runs aborted early: " << icp_aborted << std::endl;
+  }
+  // LCOV_EXCL_STOP
   return true;
 }
@@ -9,6 +9,8 @@
 #include "correspondences/common/base.hpp"
 #include "correspondences/qap/qap.hpp"
 #include "correspondences/mc/mc.hpp"
+#include "correspondences/sm/sm.hpp"
+#include "correspondences/sdp/sdp.hpp"
 //! project headers
 #include "nmsac/registration.hpp"
 #include "nmsac/helper.hpp"
@@ -65,6 +67,20 @@ bool nmsac::registration(arma::mat const & src_sub, arma::mat const & tgt_sub,
     std::shared_ptr<cor::mc::Config> mc_config =
       std::dynamic_pointer_cast<cor::mc::Config>(config.algo_config);
     corr_object = std::make_unique<cor::MC>(src_sub, tgt_sub, *mc_config);
+  } else if (config.algorithm == algorithms_e::sm) {
+    /**
+     * setup SM - spectral matching algorithm
+     */
+    std::shared_ptr<cor::sm::Config> sm_config =
+      std::dynamic_pointer_cast<cor::sm::Config>(config.algo_config);
+    corr_object = std::make_unique<cor::SM>(src_sub, tgt_sub, *sm_config);
+  } else if (config.algorithm == algorithms_e::sdp) {
+    /**
+     * setup SDP - low-rank semidefinite relaxation
+     */
+    std::shared_ptr<cor::sdp::Config> sdp_config =
+      std::dynamic_pointer_cast<cor::sdp::Config>(config.algo_config);
+    corr_object = std::make_unique<cor::SDP>(src_sub, tgt_sub, *sdp_config);
   }
 
   /**
@@ -0,0 +1,114 @@
+//! c/c++ headers
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+//! googletest
+#include "gtest/gtest.h"
+//! dependency headers
+#include <armadillo>
+//! unit-under-test header
+#include "correspondences/common/lap.hpp"
+
+namespace cor = correspondences;
+
+//! The fixture for testing class LinearAssignment.
+class LAPTest : public ::testing::Test {
+ protected:
+   /**
+    * constants for test
+    */
+   // You can remove any or all of the following functions if their bodies would
+   // be empty.
+
+   LAPTest() {
+     // You can do set-up work for each test here.
+   }
+
+   ~LAPTest() override {
+     // You can do clean-up work that doesn't throw exceptions here.
+   }
+
+   // If the constructor and destructor are not enough for setting up
+   // and cleaning up each test, you can define the following methods:
+
+   void SetUp() override {
+     // Code here will be called immediately after the constructor (right
+     // before each test).
+   }
+
+   void TearDown() override {
+     // Code here will be called immediately after each test (right
+     // before the destructor).
+   }
+
+   // Class members declared here can be used by all tests in the test suite
+   // for Foo.
+};
+
+TEST_F(LAPTest, CompareToBruteForce) {
+  arma::arma_rng::set_seed(11011);
+  cor::LinearAssignment lap;
+  for (size_t dim = 1; dim <= 6; ++dim) {
+    arma::mat const cost = arma::randu(dim, dim);
+
+    //! TEST 1: solver converges and returns a permutation
+    arma::uvec row_to_col;
+    ASSERT_TRUE( lap.solve(cost, row_to_col) );
+    ASSERT_TRUE( arma::all(arma::sort(row_to_col) == arma::regspace<arma::uvec>(0, dim-1)) );
+
+    //! TEST 2: total cost matches the best permutation found by enumeration
+    double total = 0;
+    for (size_t i = 0; i < dim; ++i) {
+      total += cost(i, row_to_col(i));
+    }
+    std::vector<size_t> perm(dim);
+    std::iota(perm.begin(), perm.end(), 0);
+    double best = std::numeric_limits<double>::max();
+    do {
+      double candidate = 0;
+      for (size_t i = 0; i < dim; ++i) {
+        candidate += cost(i, perm[i]);
+      }
+      best = std::min(best, candidate);
+    } while (std::next_permutation(perm.begin(), perm.end()));
+    EXPECT_NEAR(total, best, 1e-12);
+  }
+}
+
+TEST_F(LAPTest, SlackRowAndColumn) {
+  //! 3 source points, 4 target points; source 1 prefers slack, target 3 is never chosen
+  size_t const m = 3;
+  size_t const n = 4;
+  arma::mat scores(m+1, n+1, arma::fill::zeros);
+  scores(0, 2) = 0.9;
+  scores(0, 0) = 0.2;
+  scores(1, 0) = 0.1;
+  scores(1, n) = 0.5;
+  scores(2, 0) = 0.8;
+  scores(2, 1) = -0.7;  // negative scores must never be preferred
+  scores(m, 3) = 0.3;
+
+  //! flatten row-major, matching the QAP state layout
+  arma::colvec const profit = arma::vectorise(scores.t());
+  arma::colvec x_opt(profit.n_elem);
+  cor::LinearAssignment lap;
+  ASSERT_TRUE( lap.solve_with_slack(profit, m, n, x_opt) );
+
+  arma::mat const X = arma::reshape(x_opt, n+1, m+1).t();
+  //! TEST 1: assignment constraints (slack row/column excluded from their own sums)
+  for (size_t i = 0; i < m; ++i) {
+    EXPECT_DOUBLE_EQ(arma::accu(X.row(i)), 1.);
+  }
+  for (size_t j = 0; j < n; ++j) {
+    EXPECT_DOUBLE_EQ(arma::accu(X.col(j)), 1.);
+  }
+  EXPECT_DOUBLE_EQ(X(m, n), 0.);
+
+  //! TEST 2: expected (unique) optimum
+  EXPECT_DOUBLE_EQ(X(0, 2), 1.);
+  EXPECT_DOUBLE_EQ(X(1, n), 1.);
+  EXPECT_DOUBLE_EQ(X(2, 0), 1.);
+  EXPECT_DOUBLE_EQ(X(m, 1), 1.);
+  EXPECT_DOUBLE_EQ(X(m, 3), 1.);
+}
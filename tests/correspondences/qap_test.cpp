@@ -2,6 +2,7 @@
 #include <string>
 #include <fstream>
 #include <memory>
+#include <set>
 #include <streambuf>
 //! googletest
 #include "gtest/gtest.h"
@@ -186,3 +187,132 @@ TEST_F(QAPTest, PartialSourceMatching) {
     ASSERT_TRUE(corrs.find(key) != corrs.end());
   }
 }
+
+TEST_F(QAPTest, VariableElimination) {
+  //! load unit test data from json
+  //! NOTE: this test data was generated without adding noise
+  std::ifstream ifs(data_path_ + "/registration-data.json");
+  std::string json_str = std::string((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  json json_data = json::parse(json_str);
+
+  //! source pts
+  auto const rows_S = json_data["source_pts"].size();
+  auto const cols_S = json_data["source_pts"][0].size();
+  size_t i = 0;
+  arma::mat src_pts(rows_S, cols_S);
+  for (auto const & it : json_data["source_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      src_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! target pts
+  auto const rows_T = json_data["target_pts"].size();
+  auto const cols_T = json_data["target_pts"][0].size();
+  i = 0;
+  arma::mat tgt_pts(rows_T, cols_T);
+  for (auto const & it : json_data["target_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      tgt_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! setup configuration struct for test
+  cq::Config config;
+  config.epsilon = 0.015;
+  config.pairwise_dist_threshold = 0.015;
+  config.min_corr = src_pts.n_cols;
+
+  cq::ConstrainedObjective const obj(src_pts, tgt_pts, config);
+  auto const & m = obj.num_source_pts();
+  auto const & n = obj.num_target_pts();
+
+  //! TEST 1: all slack variables (except slack-to-slack) and all supported variables are kept
+  ASSERT_EQ(obj.num_vars(), obj.num_supported() + m + n);
+  ASSERT_LT(obj.num_vars(), obj.state_length());
+
+  //! TEST 2: true correspondences are never eliminated
+  std::set<size_t> kept;
+  for (size_t r = 0; r < obj.num_vars(); ++r) {
+    kept.insert(obj.full_index(r));
+  }
+  ASSERT_TRUE(kept.find(m*(n+1) + n) == kept.end());
+  i = 0;
+  for (auto const & it : json_data["correspondences"]) {
+    ASSERT_TRUE(kept.find(i*(n+1) + static_cast<size_t>(it)) != kept.end());
+    ++i;
+  }
+}
+
+TEST_F(QAPTest, Initialization) {
+  //! load unit test data from json
+  //! NOTE: this test data was generated without adding noise
+  std::ifstream ifs(data_path_ + "/registration-data.json");
+  std::string json_str = std::string((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  json json_data = json::parse(json_str);
+
+  //! source pts
+  auto const rows_S = json_data["source_pts"].size();
+  auto const cols_S = json_data["source_pts"][0].size();
+  size_t i = 0;
+  arma::mat src_pts(rows_S, cols_S);
+  for (auto const & it : json_data["source_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      src_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! target pts
+  auto const rows_T = json_data["target_pts"].size();
+  auto const cols_T = json_data["target_pts"][0].size();
+  i = 0;
+  arma::mat tgt_pts(rows_T, cols_T);
+  for (auto const & it : json_data["target_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      tgt_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! setup configuration struct for test
+  cq::Config config;
+  config.epsilon = 0.1;
+  config.pairwise_dist_threshold = 0.1;
+  config.corr_threshold = 0.9;
+  config.n_pair_threshold = 100;
+  config.min_corr = src_pts.n_cols;
+  auto const & n = tgt_pts.n_cols;
+
+  for (auto const & init : {cq::init_e::zero, cq::init_e::spectral}) {
+    config.init = init;
+    cor::QAP qap(src_pts, tgt_pts, config);
+
+    //! TEST 1: the spectral initial point exists for this data (so it is actually used)
+    arma::colvec z0;
+    ASSERT_TRUE( qap.spectral_guess(z0) );
+
+    //! TEST 2: IPOPT converges from the initial point
+    ASSERT_TRUE( qap.calc_optimum() == cor::QAP::ipopt_status_t::success );
+
+    //! TEST 3: and the (projected) optimum contains the true correspondences
+    arma::colvec const optimum = qap.get_optimum();
+    i = 0;
+    for (auto const & it : json_data["correspondences"]) {
+      ASSERT_GE(optimum(i*(n+1) + static_cast<size_t>(it)), config.corr_threshold);
+      ++i;
+    }
+  }
+}
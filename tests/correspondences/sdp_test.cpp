@@ -0,0 +1,190 @@
+//! c/c++ headers
+#include <string>
+#include <fstream>
+#include <memory>
+#include <streambuf>
+//! googletest
+#include "gtest/gtest.h"
+//! dependency headers
+#include "TestData.h"  // unit test configuration data (generated by CMake)
+#include <nlohmann/json.hpp>
+//! unit-under-test header
+#include "correspondences/sdp/sdp.hpp"
+
+namespace cor = correspondences;
+namespace cs = cor::sdp;
+
+using json = nlohmann::json;
+
+//! The fixture for testing class SDP.
+class SDPTest : public ::testing::Test {
+ protected:
+   /**
+    * constants for test
+    */
+   // You can remove any or all of the following functions if their bodies would
+   // be empty.
+
+   SDPTest() : data_path_(DATA_PATH) {
+     // You can do set-up work for each test here.
+   }
+
+   ~SDPTest() override {
+     // You can do clean-up work that doesn't throw exceptions here.
+   }
+
+   // If the constructor and destructor are not enough for setting up
+   // and cleaning up each test, you can define the following methods:
+
+   void SetUp() override {
+     // Code here will be called immediately after the constructor (right
+     // before each test).
+   }
+
+   void TearDown() override {
+     // Code here will be called immediately after each test (right
+     // before the destructor).
+   }
+
+   // Class members declared here can be used by all tests in the test suite
+   // for Foo.
+   const std::string data_path_;
+};
+
+TEST_F(SDPTest, FullSourceMatching) {
+  //! load unit test data from json
+  //! NOTE: this test data was generated without adding noise
+  std::ifstream ifs(data_path_ + "/registration-data.json");
+  std::string json_str = std::string((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  json json_data = json::parse(json_str);
+
+  //! setup configuration struct for test
+  //! @note this algorithm is very sensitive to the epsilon and pairwise_dist_threshold settings!!
+  cs::Config config;
+  config.epsilon = 0.015;
+  config.pairwise_dist_threshold = 0.015;
+
+  //! source pts
+  auto const rows_S = json_data["source_pts"].size();
+  auto const cols_S = json_data["source_pts"][0].size();
+  size_t i = 0;
+  arma::mat src_pts(rows_S, cols_S);
+  for (auto const & it : json_data["source_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      src_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! target pts
+  auto const rows_T = json_data["target_pts"].size();
+  auto const cols_T = json_data["target_pts"][0].size();
+  i = 0;
+  arma::mat tgt_pts(rows_T, cols_T);
+  for (auto const & it : json_data["target_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      tgt_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! correspondences
+  i = 0;
+  cor::correspondences_t _corrs;
+  for (auto const & it : json_data["correspondences"]) {
+    auto key = std::make_pair(i, static_cast<size_t>(it));
+    _corrs[key] = 1;
+    ++i;
+  }
+
+  cor::correspondences_t corrs;
+  std::unique_ptr<cor::CorrespondencesBase> sdp = std::make_unique<cor::SDP>(
+      src_pts, tgt_pts, config);
+  ASSERT_TRUE( sdp->calc_correspondences(corrs) == cor::status_e::success );
+
+  /**
+   * checking that the same keys are present in both correspondence sets is enough;
+   * @note scores are relative to the best pair; the relaxation is tight for the inliers, so
+   * accepted scores are close to 1
+   */
+  ASSERT_EQ(corrs.size(), _corrs.size());
+  for (auto const & c : _corrs) {
+    auto const it = corrs.find(c.first);
+    ASSERT_TRUE(it != corrs.end());
+    ASSERT_TRUE(it->second > 0.9 && it->second <= 1);
+  }
+}
+
+TEST_F(SDPTest, PartialSourceMatching) {
+  //! load unit test data from json
+  //! NOTE: this test data was generated without adding noise
+  std::ifstream ifs(data_path_ + "/registration-data-mincorr.json");
+  std::string json_str = std::string((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  json json_data = json::parse(json_str);
+
+  //! setup configuration struct for test
+  //! @note this algorithm is very sensitive to the epsilon and pairwise_dist_threshold settings!!
+  cs::Config config;
+  config.epsilon = 0.015;
+  config.pairwise_dist_threshold = 0.015;
+
+  //! source pts
+  auto const rows_S = json_data["source_pts"].size();
+  auto const cols_S = json_data["source_pts"][0].size();
+  size_t i = 0;
+  arma::mat src_pts(rows_S, cols_S);
+  for (auto const & it : json_data["source_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      src_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! target pts
+  auto const rows_T = json_data["target_pts"].size();
+  auto const cols_T = json_data["target_pts"][0].size();
+  i = 0;
+  arma::mat tgt_pts(rows_T, cols_T);
+  for (auto const & it : json_data["target_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      tgt_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! correspondences
+  i = 0;
+  cor::correspondences_t _corrs;
+  for (auto const & it : json_data["correspondences"]) {
+    auto key = std::make_pair(i, static_cast<size_t>(it));
+    _corrs[key] = 1;
+    ++i;
+  }
+
+  cor::correspondences_t corrs;
+  std::unique_ptr<cor::CorrespondencesBase> sdp = std::make_unique<cor::SDP>(
+      src_pts, tgt_pts, config);
+  ASSERT_TRUE( sdp->calc_correspondences(corrs) == cor::status_e::success );
+
+  /**
+   * checking that the same keys are present in both correspondence sets is enough;
+   * @note scores are relative to the best pair; the relaxation is tight for the inliers, so
+   * accepted scores are close to 1
+   */
+  ASSERT_EQ(corrs.size(), _corrs.size());
+  for (auto const & c : _corrs) {
+    auto const it = corrs.find(c.first);
+    ASSERT_TRUE(it != corrs.end());
+    ASSERT_TRUE(it->second > 0.9 && it->second <= 1);
+  }
+}
@@ -1,4 +1,5 @@
 //! c/c++ headers
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <fstream>
@@ -114,3 +115,86 @@ TEST_F(CommonTest, LinearProgrammingTest) {
   double const obj_val = arma::dot(c, x_opt);
   EXPECT_DOUBLE_EQ(obj_val, obj_val_matlab);
 }
+
+TEST_F(CommonTest, SpectralGreedyAssignment) {
+  //! load unit test data from json
+  //! NOTE: this test data was generated without adding noise
+  std::ifstream ifs(data_path_ + "/registration-data.json");
+  std::string json_str = std::string((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  json json_data = json::parse(json_str);
+
+  //! source pts
+  auto const rows_S = json_data["source_pts"].size();
+  auto const cols_S = json_data["source_pts"][0].size();
+  size_t i = 0;
+  arma::mat src_pts(rows_S, cols_S);
+  for (auto const & it : json_data["source_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      src_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! target pts
+  auto const rows_T = json_data["target_pts"].size();
+  auto const cols_T = json_data["target_pts"][0].size();
+  i = 0;
+  arma::mat tgt_pts(rows_T, cols_T);
+  for (auto const & it : json_data["target_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      tgt_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! correspondences
+  i = 0;
+  cor::correspondences_t _corrs;
+  for (auto const & it : json_data["correspondences"]) {
+    auto key = std::make_pair(i, static_cast<size_t>(it));
+    _corrs[key] = 1;
+    ++i;
+  }
+
+  size_t const & m = src_pts.n_cols;
+  size_t const & n = tgt_pts.n_cols;
+  auto const weights = cor::generate_weight_tensor(src_pts, tgt_pts, 0.015, 0.015);
+
+  //! TEST 1: leading eigenvector is unit-norm and nonnegative
+  arma::colvec x;
+  ASSERT_TRUE( cor::leading_eigenvector(weights, m, n, 200, 1e-9, x) );
+  ASSERT_EQ(x.n_elem, m * n);
+  EXPECT_NEAR(arma::norm(x, 2), 1., FLOAT_TOL);
+  EXPECT_TRUE( arma::all(x >= 0) );
+
+  //! TEST 2: greedy discretization recovers the true correspondences
+  cor::correspondences_t corrs;
+  cor::greedy_assignment(x, m, n, m, 0., corrs);
+  ASSERT_EQ(corrs.size(), _corrs.size());
+  for (auto const & c : _corrs) {
+    ASSERT_TRUE(corrs.find(c.first) != corrs.end());
+  }
+
+  //! TEST 3: empty affinity is reported
+  ASSERT_FALSE( cor::leading_eigenvector({}, m, n, 200, 1e-9, x) );
+
+  //! TEST 4: star-shaped affinity (pair (0, 0) consistent with (1, 1) and (2, 2), which are not
+  //! consistent with each other) is bipartite, so M has eigenvalues +-sqrt(2); the iterate still
+  //! converges to the leading eigenvector (1/sqrt(2), 1/2, 1/2) on those pairs
+  cor::WeightTensor star;
+  for (size_t const p : {1, 2}) {
+    star[cor::WeightKey_t(0, 0, p, p)] = -1;
+    star[cor::WeightKey_t(p, p, 0, 0)] = -1;
+  }
+  size_t const n_star = 3;
+  ASSERT_TRUE( cor::leading_eigenvector(star, n_star, n_star, 1000, 1e-12, x) );
+  EXPECT_NEAR(x(0), 1. / std::sqrt(2.), 1e-6);
+  EXPECT_NEAR(x(1*n_star + 1), 0.5, 1e-6);
+  EXPECT_NEAR(x(2*n_star + 2), 0.5, 1e-6);
+  EXPECT_EQ(x(1), 0);
+}
@@ -2,6 +2,7 @@
 #include <fstream>
 #include <streambuf>
 #include <string>
+#include <vector>
 //! googletest
 #include "gtest/gtest.h"
 //! dependency headers
@@ -100,4 +101,59 @@ TEST_F(HelperTest, CountCorrespondences) {
 
   //! check equality of output
   ASSERT_TRUE(n_inliers == n_inliers_matlab);
+
+  //! TEST CASE 2: fixed-radius index gives the same count
+  transforms::VoxelHash const tgt_voxels(tgt_pts_matlab, eps);
+  ASSERT_EQ(count_correspondences(src_pts_xform_matlab, tgt_voxels, eps), n_inliers_matlab);
+
+  //! TEST CASE 3: inlier oracle gives the same count
+  transforms::InlierOracle const tgt_oracle(tgt_pts_matlab, eps);
+  ASSERT_EQ(count_correspondences(src_pts_xform_matlab, tgt_oracle, eps), n_inliers_matlab);
+
+  //! TEST CASE 4: fused transform-and-count gives the same count
+  arma::mat33 const R_xform = arma::eye(3, 3);
+  arma::vec3 const t_xform = arma::zeros(3);
+  ASSERT_EQ(count_correspondences(src_pts_xform_matlab, R_xform, t_xform, tgt_oracle, eps),
+      n_inliers_matlab);
+
+  //! TEST CASE 5: parallel exact searcher gives the same count
+  transforms::ParallelSearcher const tgt_parallel(tgt_pts_matlab);
+  ASSERT_EQ(count_correspondences(src_pts_xform_matlab, tgt_parallel, eps), n_inliers_matlab);
+
+  //! TEST CASE 6: the count does not depend on the order of the points
+  arma::mat const src_sorted = morton_reorder(src_pts_xform_matlab);
+  transforms::ParallelSearcher const tgt_sorted(morton_reorder(tgt_pts_matlab));
+  ASSERT_EQ(count_correspondences(src_sorted, tgt_sorted, eps), n_inliers_matlab);
+}
+
+TEST_F(HelperTest, MortonReorder) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  size_t const n_pts = 5000;
+  arma::mat const pts = arma::randu(3, n_pts);
+
+  //! TEST CASE 1: the sorted copy is a permutation of the input, recorded in `order`
+  std::vector<size_t> order;
+  arma::mat const sorted = morton_reorder(pts, &order);
+  ASSERT_EQ(sorted.n_cols, n_pts);
+  ASSERT_EQ(order.size(), n_pts);
+  std::vector<bool> seen(n_pts, false);
+  for (size_t i = 0; i < n_pts; ++i) {
+    ASSERT_LT(order[i], n_pts);
+    ASSERT_FALSE(seen[order[i]]);
+    seen[order[i]] = true;
+    ASSERT_TRUE( arma::all(sorted.col(i) == pts.col(order[i])) );
+  }
+
+  //! TEST CASE 2: consecutive points are much closer than in the (random) input order
+  auto const path_length = [](arma::mat const & p) {
+    return arma::accu(arma::sqrt(arma::sum(arma::square(
+              p.tail_cols(p.n_cols - 1) - p.head_cols(p.n_cols - 1)))));
+  };
+  ASSERT_LT(path_length(sorted), 0.25 * path_length(pts));
+
+  //! TEST CASE 3: an empty cloud stays empty
+  arma::mat const empty = morton_reorder(arma::mat(3, 0), &order);
+  ASSERT_EQ(empty.n_cols, static_cast<size_t>(0));
+  ASSERT_TRUE(order.empty());
 }
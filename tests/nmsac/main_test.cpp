@@ -1,6 +1,9 @@
 //! c/c++ headers
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <fstream>
+#include <iostream>
 #include <streambuf>
 //! googletest
 #include "gtest/gtest.h"
@@ -208,3 +211,137 @@ TEST_F(MainTest, CubeTestMc) {
   //! TEST 3: check that num_inliers = size(src_pts)
   ASSERT_TRUE(num_inliers == src_pts.n_cols);
 }
+
+//! early abort of icp runs is a lossy heuristic in general; on this dataset (no outliers) it
+//! gives the same result as a run without it
+TEST_F(MainTest, CubeTestEarlyAbort) {
+  //! load unit test data from json
+  std::ifstream ifs(data_path_ + "/cube-test.json");
+  std::string json_str = std::string((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  json json_data = json::parse(json_str);
+
+  //! source pts
+  auto const rows_S = json_data["source_pts"].size();
+  auto const cols_S = json_data["source_pts"][0].size();
+  size_t i = 0;
+  arma::mat src_pts(rows_S, cols_S);
+  for (auto const & it : json_data["source_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      src_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  //! target pts
+  auto const rows_T = json_data["target_pts"].size();
+  auto const cols_T = json_data["target_pts"][0].size();
+  i = 0;
+  arma::mat tgt_pts(rows_T, cols_T);
+  for (auto const & it : json_data["target_pts"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      tgt_pts(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+
+  size_t const max_iter = 20;
+  nlohmann::json json_config = {
+    { "max_iter", max_iter },
+    { "mc", {
+               {"epsilon", 0.015},
+               {"pairwise_dist_threshold", 1e-2},
+               {"algorithm", 0}
+             }
+    }
+  };
+
+  //! reference: no early abort
+  arma::mat33 R_ref;
+  arma::vec3 t_ref;
+  size_t num_inliers_ref, its_ref;
+  ASSERT_TRUE( nmsac::main(src_pts, tgt_pts, json_config, R_ref, t_ref, num_inliers_ref,
+        its_ref) );
+  ASSERT_LE(its_ref, max_iter);
+
+  //! TEST 1: with early abort, the iteration budget still holds
+  json_config["icp_abort_after"] = 1;
+  arma::mat33 R_opt;
+  arma::vec3 t_opt;
+  size_t num_inliers, its;
+  ASSERT_TRUE( nmsac::main(src_pts, tgt_pts, json_config, R_opt, t_opt, num_inliers, its) );
+  ASSERT_LE(its, max_iter);
+
+  //! TEST 2: the result matches the run without early abort (on this dataset)
+  ASSERT_EQ(num_inliers, num_inliers_ref);
+  ASSERT_TRUE(arma::approx_equal(R_opt, R_ref, "absdiff", FLOAT_TOL));
+  ASSERT_TRUE(arma::approx_equal(t_opt, t_ref, "absdiff", FLOAT_TOL));
+}
+
+//! throughput with and without Morton ordering of the clouds; disabled by default, run with
+//! `main_test --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*`
+TEST_F(MainTest, DISABLED_BenchmarkMortonOrder) {
+  //! load the true transformation of the cube test
+  std::ifstream ifs(data_path_ + "/cube-test.json");
+  std::string json_str = std::string((std::istreambuf_iterator<char>(ifs)),
+      std::istreambuf_iterator<char>());
+  json json_data = json::parse(json_str);
+  size_t i = 0;
+  arma::mat33 _R;
+  for (auto const & it : json_data["R_true"]) {
+    size_t j = 0;
+    for (auto const & jt : it) {
+      _R(i, j) = static_cast<double>(jt);
+      ++j;
+    }
+    ++i;
+  }
+  i = 0;
+  arma::vec3 _t;
+  for (auto const & it : json_data["t_true"]) {
+    _t(i) = static_cast<double>(it);
+    ++i;
+  }
+
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  for (size_t const n_pts : {10000, 100000}) {
+    //! larger version of the cube test: points on the faces of the cube [-1, 1]^3, in random order
+    arma::mat src_pts = 2 * arma::randu(3, n_pts) - 1;
+    arma::uvec const faces = arma::randi<arma::uvec>(n_pts, arma::distr_param(0, 5));
+    for (size_t k = 0; k < n_pts; ++k) {
+      src_pts(faces(k) % 3, k) = (faces(k) < 3) ? -1 : 1;
+    }
+    arma::mat tgt_pts = _R * src_pts;
+    tgt_pts.each_col() += _t;
+    tgt_pts = tgt_pts.cols(arma::randperm(n_pts));
+
+    std::cout << "points: " << n_pts << std::endl;
+    for (bool const morton_order : {false, true}) {
+      nlohmann::json json_config = {
+        { "max_iter", 20 },
+        { "morton_order", morton_order },
+        { "mc", {
+                   {"epsilon", 0.015},
+                   {"pairwise_dist_threshold", 1e-2},
+                   {"algorithm", 0}
+                 }
+        }
+      };
+      arma::mat33 R_opt;
+      arma::vec3 t_opt;
+      size_t num_inliers, its;
+      auto const start = std::chrono::steady_clock::now();
+      ASSERT_TRUE( nmsac::main(src_pts, tgt_pts, json_config, R_opt, t_opt, num_inliers, its) );
+      std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "  morton_order " << morton_order << ": time (s) " << elapsed.count() <<
+        ", iterations " << its << ", time per iteration (s) " <<
+        elapsed.count() / static_cast<double>(std::max(its, static_cast<size_t>(1))) <<
+        ", consensus size " << num_inliers << std::endl;
+    }
+  }
+}
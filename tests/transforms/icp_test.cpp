@@ -1,6 +1,8 @@
 //! c/c++ headers
+#include <chrono>
 #include <string>
 #include <fstream>
+#include <iostream>
 #include <streambuf>
 //! googletest
 #include "gtest/gtest.h"
@@ -37,6 +39,10 @@ class ICPTest : public ::testing::Test {
    void SetUp() override {
      // Code here will be called immediately after the constructor (right
      // before each test).
+     make_scene(600);
+     config_.max_its = 100;
+     config_.tolerance = 1e-9;
+     config_.reject_ratio = 0.1;
    }
 
    void TearDown() override {
@@ -44,9 +50,35 @@ class ICPTest : public ::testing::Test {
      // before the destructor).
    }
 
+   /** ICPTest::make_scene(n_pts, psi, theta, phi)
+    * @brief (re)build the structured scene: `n_pts` points sampled on the faces of a 4x2x1 box
+    * (`dst_`), and source points `src_` = R_.t()*(dst_ - t_), so that R_*src_ + t_ == dst_;
+    * the random seed is reset first, for repeatability
+    *
+    * @param[in] n_pts number of points
+    * @param[in] psi, theta, phi euler angles of `R_`
+    * @return
+    */
+   void make_scene(size_t const & n_pts, double const & psi = 0.1, double const & theta = -0.05,
+       double const & phi = 0.033) {
+     arma::arma_rng::set_seed(11011);
+     n_pts_ = n_pts;
+     make_box_scene(n_pts_, dst_);
+     make_euler(psi, theta, phi, R_);
+     src_ = R_.t() * (dst_ - arma::repmat(t_, 1, n_pts_));
+   }
+
    // Class members declared here can be used by all tests in the test suite
    // for Foo.
    const std::string data_path_;
+   //! structured scene (see `make_scene`) and base configuration for the box-scene tests; each
+   //! test changes only what it exercises
+   size_t n_pts_;
+   arma::mat dst_, src_;
+   arma::mat33 R_;
+   arma::vec3 const t_ = {0.1, -0.05, 0.08};
+   arma::mat44 const H_init_{arma::fill::eye};
+   transforms::ICPConfig config_;
 };
 
 TEST_F(ICPTest, PerturbSourcePointsWithNoise) {
@@ -254,3 +286,512 @@ TEST_F(ICPTest, TestFromNMSAC) {
   ASSERT_TRUE( transforms::iterative_closest_point(src_pts, dst_pts, H_init, max_its,
         tol, rej_ratio, H_opt) );
 }
+
+TEST_F(ICPTest, PointToPlane) {
+  //! TEST CASE 1: point-to-point baseline
+  arma::mat44 H_p2p;
+  transforms::ICPStats stats_p2p;
+  config_.method = transforms::icp_method_e::point_to_point;
+  transforms::ICPTarget target_p2p(dst_, config_);
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target_p2p, H_init_, config_, H_p2p,
+        &stats_p2p) );
+  ASSERT_TRUE( target_p2p.normals().is_empty() );
+
+  //! TEST CASE 2: point-to-plane recovers the same transformation in fewer iterations
+  arma::mat44 H_p2pl;
+  transforms::ICPStats stats_p2pl;
+  config_.method = transforms::icp_method_e::point_to_plane;
+  transforms::ICPTarget target_p2pl(dst_, config_);
+  ASSERT_EQ(target_p2pl.normals().n_cols, n_pts_);
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target_p2pl, H_init_, config_, H_p2pl,
+        &stats_p2pl) );
+  arma::mat33 const R_opt = H_p2pl(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_opt = H_p2pl(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_opt, R_, "absdiff", 1e-6) );
+  ASSERT_TRUE( arma::approx_equal(t_opt, t_, "absdiff", 1e-6) );
+  ASSERT_LE(stats_p2pl.iterations, stats_p2p.iterations);
+}
+
+TEST_F(ICPTest, GeneralizedICP) {
+  //! TEST CASE 1: point-to-point baseline
+  arma::mat44 H_p2p;
+  transforms::ICPStats stats_p2p;
+  transforms::ICPTarget target_p2p(dst_, config_);
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target_p2p, H_init_, config_, H_p2p,
+        &stats_p2p) );
+
+  //! TEST CASE 2: covariances are cached on the target and are symmetric positive-definite
+  config_.method = transforms::icp_method_e::gicp;
+  transforms::ICPTarget target(dst_, config_);
+  ASSERT_EQ(target.covariances().n_slices, n_pts_);
+  for (size_t i = 0; i < n_pts_; ++i) {
+    arma::mat33 const C = target.covariances().slice(i);
+    ASSERT_TRUE( arma::approx_equal(C, C.t(), "absdiff", FLOAT_TOL) );
+    ASSERT_NEAR(arma::trace(C), 2 + config_.covariance_epsilon, FLOAT_TOL);
+  }
+
+  //! TEST CASE 3: gicp with precomputed source covariances recovers the transformation in no
+  //! more iterations than point-to-point
+  transforms::KDTreeSearcher src_searcher(src_);
+  arma::cube src_covs;
+  transforms::estimate_covariances(src_, src_searcher, config_.normal_neighbors,
+      config_.covariance_epsilon, src_covs);
+  arma::mat44 H_gicp;
+  transforms::ICPStats stats_gicp;
+  ASSERT_TRUE( transforms::generalized_icp(src_, src_covs, target, H_init_, config_, H_gicp,
+        &stats_gicp) );
+  arma::mat33 const R_opt = H_gicp(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_opt = H_gicp(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_opt, R_, "absdiff", 1e-6) );
+  ASSERT_TRUE( arma::approx_equal(t_opt, t_, "absdiff", 1e-6) );
+  ASSERT_LE(stats_gicp.iterations, stats_p2p.iterations);
+
+  //! TEST CASE 4: convenience overload (source covariances estimated internally) agrees
+  arma::mat44 H_conv;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_conv) );
+  ASSERT_TRUE( arma::approx_equal(H_conv, H_gicp, "absdiff", FLOAT_TOL) );
+}
+
+TEST_F(ICPTest, AndersonAcceleration) {
+  config_.anderson_depth = 4;
+  transforms::ICPTarget target(dst_, config_);
+
+  //! TEST CASE 1: exact correspondences exist; the accelerated iteration recovers the
+  //! transformation
+  arma::mat44 H_opt;
+  transforms::ICPStats stats;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_opt, &stats) );
+  arma::mat33 const R_opt = H_opt(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_opt = H_opt(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_opt, R_, "absdiff", 1e-6) );
+  ASSERT_TRUE( arma::approx_equal(t_opt, t_, "absdiff", 1e-6) );
+  ASSERT_LE(stats.anderson_resets, stats.iterations);
+
+  //! TEST CASE 2: source resampled from the same surfaces (no exact correspondences); the
+  //! accelerated iteration still converges to (approximately) the true transformation
+  arma::mat resampled;
+  make_box_scene(n_pts_, resampled);
+  arma::mat const src_resampled = R_.t() * (resampled - arma::repmat(t_, 1, n_pts_));
+  config_.tolerance = 1e-7;
+  transforms::ICPStats stats_resampled;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_resampled, target, H_init_, config_, H_opt,
+        &stats_resampled) );
+  arma::mat33 const R_resampled = H_opt(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_resampled = H_opt(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_resampled, R_, "absdiff", 0.1) );
+  ASSERT_TRUE( arma::approx_equal(t_resampled, t_, "absdiff", 0.1) );
+  ASSERT_NEAR(arma::det(R_resampled), 1, FLOAT_TOL);
+}
+
+TEST_F(ICPTest, CoarseToFine) {
+  make_scene(3000, 0.2, -0.1, 0.067);
+  transforms::ICPTarget target(dst_, config_);
+
+  //! TEST CASE 1: full resolution; every iteration queries every source point
+  arma::mat44 H_full;
+  transforms::ICPStats stats_full;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_full,
+        &stats_full) );
+  ASSERT_EQ(stats_full.nn_queries, stats_full.iterations * n_pts_);
+
+  //! TEST CASE 2: coarse-to-fine schedule recovers the transformation with fewer queries
+  config_.coarse_fraction = 0.05;
+  arma::mat44 H_c2f;
+  transforms::ICPStats stats_c2f;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_c2f,
+        &stats_c2f) );
+  arma::mat33 const R_opt = H_c2f(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_opt = H_c2f(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_opt, R_, "absdiff", 1e-6) );
+  ASSERT_TRUE( arma::approx_equal(t_opt, t_, "absdiff", 1e-6) );
+  ASSERT_LT(stats_c2f.nn_queries, stats_full.nn_queries);
+
+  //! TEST CASE 3: the schedule is repeatable for a fixed seed
+  arma::mat44 H_repeat;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_repeat) );
+  ASSERT_TRUE( arma::approx_equal(H_repeat, H_c2f, "absdiff", FLOAT_TOL) );
+}
+
+TEST_F(ICPTest, ApproximateNeighbors) {
+  make_scene(3000);
+  config_.nn_epsilon = 0.5;
+  transforms::ICPTarget target(dst_, config_);
+
+  //! TEST CASE 1: approximate matches still recover the transformation exactly; at convergence
+  //! the only match within the error bound of a zero-distance neighbor is the neighbor itself
+  arma::mat44 H_opt;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_opt) );
+  arma::mat33 const R_opt = H_opt(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_opt = H_opt(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_opt, R_, "absdiff", 1e-6) );
+  ASSERT_TRUE( arma::approx_equal(t_opt, t_, "absdiff", 1e-6) );
+
+  //! TEST CASE 2: the shared searcher is left in exact mode (e.g. for counting inliers)
+  ASSERT_EQ(target.searcher().Epsilon(), 0);
+
+  //! TEST CASE 3: a target built for exact matches has no mlpack searcher to run approximate
+  //! matches on; icp reports failure instead of searching it
+  config_.nn_epsilon = 0;
+  transforms::ICPTarget target_exact(dst_, config_);
+  ASSERT_TRUE(target.searcher_trained());
+  ASSERT_FALSE(target_exact.searcher_trained());
+  config_.nn_epsilon = 0.5;
+  ASSERT_FALSE( transforms::iterative_closest_point(src_, target_exact, H_init_, config_, H_opt) );
+}
+
+TEST_F(ICPTest, VoxelCorrespondences) {
+  make_scene(3000);
+  config_.max_correspondence_distance = 0.5;
+  transforms::ICPTarget target(dst_, config_);
+  ASSERT_EQ(target.voxels().size(), n_pts_);
+
+  //! TEST CASE 1: fixed-radius matches recover the transformation
+  arma::mat44 H_opt;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_opt) );
+  arma::mat33 const R_opt = H_opt(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_opt = H_opt(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_opt, R_, "absdiff", 1e-6) );
+  ASSERT_TRUE( arma::approx_equal(t_opt, t_, "absdiff", 1e-6) );
+
+  //! TEST CASE 2: a source far away from the target has no matches; icp reports failure
+  arma::mat const src_far = src_ + 100;
+  ASSERT_FALSE( transforms::iterative_closest_point(src_far, target, H_init_, config_, H_opt) );
+}
+
+TEST_F(ICPTest, ParallelSearcher) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  size_t const n_pts = 2000;
+  size_t const n_queries = 5000;
+
+  //! reference points with exact duplicates (ties between nearest neighbors)
+  arma::mat pts = arma::randn(3, n_pts);
+  pts.tail_cols(n_pts / 10) = pts.head_cols(n_pts / 10);
+  arma::mat queries = 2 * arma::randn(3, n_queries);
+  queries.head_cols(n_pts / 10) = pts.head_cols(n_pts / 10);
+
+  //! reference: mlpack's exact search
+  transforms::KDTreeSearcher kd_searcher(pts);
+  arma::Mat<size_t> kd_neighbors;
+  arma::mat kd_distances;
+  kd_searcher.Search(queries, 1, kd_neighbors, kd_distances);
+
+  transforms::ParallelSearcher const searcher(pts);
+  ASSERT_EQ(searcher.size(), n_pts);
+
+  //! TEST CASE 1: same distances as mlpack; neighbors are at those distances
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  searcher.search(queries, neighbors, distances);
+  ASSERT_EQ(neighbors.n_cols, n_queries);
+  ASSERT_EQ(distances.n_cols, n_queries);
+  for (size_t i = 0; i < n_queries; ++i) {
+    ASSERT_NEAR(distances(0, i), kd_distances(0, i), FLOAT_TOL);
+    ASSERT_NEAR(arma::norm(queries.col(i) - pts.col(neighbors(0, i))), distances(0, i), FLOAT_TOL);
+  }
+
+  //! TEST CASE 2: output does not depend on how queries are split across threads
+  arma::Mat<size_t> neighbors_other;
+  arma::mat distances_other;
+  searcher.search(queries, neighbors_other, distances_other, 1);
+  ASSERT_TRUE( arma::all(arma::vectorise(neighbors_other == neighbors)) );
+  ASSERT_TRUE( arma::all(arma::vectorise(distances_other == distances)) );
+  for (size_t i = 0; i < n_queries; ++i) {
+    size_t index;
+    double distance;
+    ASSERT_TRUE( searcher.nearest(queries.colptr(i), index, distance) );
+    ASSERT_EQ(index, neighbors(0, i));
+    ASSERT_EQ(distance, distances(0, i));
+  }
+
+  //! TEST CASE 3: an empty searcher finds nothing
+  transforms::ParallelSearcher const empty;
+  size_t index = 0;
+  double distance = 0;
+  ASSERT_FALSE( empty.nearest(queries.colptr(0), index, distance) );
+
+  //! TEST CASE 4: icp targets for exact searches build the parallel searcher
+  transforms::ICPConfig config;
+  transforms::ICPTarget const target(pts, config);
+  ASSERT_EQ(target.parallel_searcher().size(), n_pts);
+  ASSERT_GT(target.parallel_searcher().num_nodes(), static_cast<size_t>(0));
+
+  //! TEST CASE 5: k nearest neighbors have the same distances as mlpack's, nearest first
+  size_t const k = 6;
+  kd_searcher.Search(queries, k, kd_neighbors, kd_distances);
+  searcher.search(queries, k, neighbors, distances);
+  ASSERT_EQ(neighbors.n_rows, k);
+  ASSERT_EQ(distances.n_rows, k);
+  for (size_t i = 0; i < n_queries; ++i) {
+    for (size_t j = 0; j < k; ++j) {
+      ASSERT_NEAR(distances(j, i), kd_distances(j, i), FLOAT_TOL);
+      ASSERT_NEAR(arma::norm(queries.col(i) - pts.col(neighbors(j, i))), distances(j, i),
+          FLOAT_TOL);
+    }
+  }
+
+  //! TEST CASE 6: normals agree (up to sign) with those from mlpack's neighbors
+  arma::mat normals, kd_normals;
+  transforms::estimate_normals(pts, searcher, config.normal_neighbors, normals);
+  transforms::estimate_normals(pts, kd_searcher, config.normal_neighbors, kd_normals);
+  ASSERT_TRUE( arma::approx_equal(arma::abs(arma::sum(normals % kd_normals)),
+        arma::ones<arma::rowvec>(n_pts), "absdiff", 1e-6) );
+}
+
+TEST_F(ICPTest, WarmStartedNeighbors) {
+  make_scene(3000);
+  transforms::ParallelSearcher const searcher(dst_);
+
+  //! TEST CASE 1: queries that drift by shrinking steps get the exact nearest-neighbor distances,
+  //! and fewer and fewer of them search the kd-tree
+  arma::mat queries = dst_ + 0.05 * arma::randn(3, n_pts_);
+  transforms::NeighborCache cache;
+  arma::Mat<size_t> neighbors, neighbors_exact;
+  arma::mat distances, distances_exact;
+  ASSERT_EQ(searcher.search(queries, cache, neighbors, distances), n_pts_);
+  size_t n_searched_last = n_pts_;
+  for (size_t it = 0; it < 10; ++it) {
+    arma::mat33 R_step;
+    double const step = 0.01 * std::pow(0.5, it);
+    make_euler(step, -step, step, R_step);
+    queries = R_step * queries;
+    queries.each_col() += arma::vec3({step, 0, -step});
+    n_searched_last = searcher.search(queries, cache, neighbors, distances);
+    searcher.search(queries, neighbors_exact, distances_exact);
+    ASSERT_TRUE( arma::approx_equal(distances, distances_exact, "absdiff", FLOAT_TOL) );
+  }
+  ASSERT_LT(n_searched_last, n_pts_ / 10);
+
+  //! TEST CASE 2: added queries start without a cache entry
+  arma::mat const more_queries = arma::join_rows(queries, dst_.head_cols(10));
+  ASSERT_EQ(searcher.search(more_queries, cache, neighbors, distances), static_cast<size_t>(10));
+  ASSERT_EQ(cache.radii.n_elem, n_pts_ + 10);
+
+  //! TEST CASE 3: warm-started icp returns the same transformation with fewer kd-tree searches
+  transforms::ICPTarget target(dst_, config_);
+  arma::mat44 H_warm, H_cold;
+  transforms::ICPStats stats_warm, stats_cold;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_warm,
+        &stats_warm) );
+  config_.nn_cache_size = 0;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_cold,
+        &stats_cold) );
+  ASSERT_TRUE( arma::approx_equal(H_warm, H_cold, "absdiff", 1e-9) );
+  ASSERT_EQ(stats_cold.nn_tree_searches, stats_cold.nn_queries);
+  ASSERT_LT(stats_warm.nn_tree_searches, stats_cold.nn_tree_searches);
+}
+
+TEST_F(ICPTest, EarlyAbort) {
+  make_scene(3000);
+  config_.abort_epsilon = 1e-3;
+  config_.abort_after = 3;
+  transforms::ICPTarget target(dst_, config_);
+
+  //! TEST CASE 1: a bound every run can reach never aborts
+  arma::mat44 H_opt;
+  transforms::ICPStats stats;
+  config_.abort_min_inliers = 0;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_opt, &stats) );
+  ASSERT_FALSE(stats.aborted);
+  arma::mat33 const R_opt = H_opt(arma::span(0, 2), arma::span(0, 2));
+  ASSERT_TRUE( arma::approx_equal(R_opt, R_, "absdiff", 1e-6) );
+
+  //! TEST CASE 2: a bound no run can reach aborts as soon as it is checked
+  transforms::ICPStats stats_aborted;
+  config_.abort_min_inliers = n_pts_ + 1;
+  config_.abort_heuristic_margin = 1;
+  ASSERT_FALSE( transforms::iterative_closest_point(src_, target, H_init_, config_, H_opt,
+        &stats_aborted) );
+  ASSERT_TRUE(stats_aborted.aborted);
+  ASSERT_EQ(stats_aborted.iterations, config_.abort_after);
+
+  //! TEST CASE 3: a hypothesis far from the target is abandoned, a good one is not
+  config_.abort_min_inliers = n_pts_ / 2;
+  config_.abort_heuristic_margin = 2;
+  arma::mat44 H_far(arma::fill::eye);
+  H_far(0, 3) = 10;
+  transforms::ICPStats stats_far;
+  ASSERT_FALSE( transforms::iterative_closest_point(src_, target, H_far, config_, H_opt,
+        &stats_far) );
+  ASSERT_TRUE(stats_far.aborted);
+  arma::mat44 H_good(arma::fill::eye);
+  H_good(arma::span(0, 2), arma::span(0, 2)) = R_;
+  H_good(arma::span(0, 2), 3) = t_;
+  transforms::ICPStats stats_good;
+  ASSERT_TRUE( transforms::iterative_closest_point(src_, target, H_good, config_, H_opt,
+        &stats_good) );
+  ASSERT_FALSE(stats_good.aborted);
+}
+
+TEST_F(ICPTest, FinalInlierCount) {
+  //! the source is a noisy, partially overlapping copy, so that only some of the points are
+  //! inliers
+  make_scene(3000);
+  arma::mat src = src_ + 0.01 * arma::randn(3, n_pts_);
+  src.tail_cols(n_pts_ / 10) += 1;
+  config_.reject_ratio = 0.2;
+  config_.inlier_epsilon = 0.015;
+  transforms::ICPTarget target(dst_, config_);
+
+  //! reference: exact count at the returned transformation
+  transforms::KDTreeSearcher kd_searcher(dst_);
+  auto count_at = [&](arma::mat44 const & H) {
+    arma::mat const src_xform = H(arma::span(0, 2), arma::span(0, 2)) * src +
+      arma::repmat(H(arma::span(0, 2), 3), 1, n_pts_);
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    kd_searcher.Search(src_xform, 1, neighbors, distances);
+    return static_cast<size_t>(arma::accu(distances <= config_.inlier_epsilon));
+  };
+
+  //! TEST CASE 1: a converged run reports the count at the returned transformation (up to
+  //! rounding of points right at the threshold)
+  arma::mat44 H_opt;
+  transforms::ICPStats stats;
+  ASSERT_TRUE( transforms::iterative_closest_point(src, target, H_init_, config_, H_opt, &stats) );
+  ASSERT_TRUE(stats.counted_inliers);
+  ASSERT_GT(stats.inliers, static_cast<size_t>(0));
+  ASSERT_LT(stats.inliers, n_pts_);
+  ASSERT_NEAR(static_cast<double>(stats.inliers), static_cast<double>(count_at(H_opt)), 2.);
+
+  //! TEST CASE 2: same with the coarse-to-fine schedule (counted over all source points)
+  config_.coarse_fraction = 0.1;
+  transforms::ICPStats stats_c2f;
+  ASSERT_TRUE( transforms::iterative_closest_point(src, target, H_init_, config_, H_opt,
+        &stats_c2f) );
+  ASSERT_TRUE(stats_c2f.counted_inliers);
+  ASSERT_NEAR(static_cast<double>(stats_c2f.inliers), static_cast<double>(count_at(H_opt)), 2.);
+
+  //! TEST CASE 3: no count from approximate matches or from a run that did not converge
+  config_.coarse_fraction = 1;
+  config_.nn_epsilon = 0.5;
+  transforms::ICPTarget target_approx(dst_, config_);
+  transforms::ICPStats stats_approx;
+  transforms::iterative_closest_point(src, target_approx, H_init_, config_, H_opt, &stats_approx);
+  ASSERT_FALSE(stats_approx.counted_inliers);
+  config_.nn_epsilon = 0;
+  config_.max_its = 1;
+  transforms::ICPStats stats_short;
+  ASSERT_FALSE( transforms::iterative_closest_point(src, target, H_init_, config_, H_opt,
+        &stats_short) );
+  ASSERT_FALSE(stats_short.counted_inliers);
+}
+
+TEST_F(ICPTest, BatchedHypotheses) {
+  make_scene(3000);
+  arma::mat const src = src_ + 1e-3 * arma::randn(3, n_pts_);
+
+  //! hypotheses: identity, small perturbations of the truth, and one far from the target
+  size_t const n_hyp = 6;
+  arma::cube H_init(4, 4, n_hyp);
+  for (size_t h = 0; h < n_hyp; ++h) {
+    arma::mat33 R_h;
+    make_euler(0.02 * h, -0.01 * h, 0.015 * h, R_h);
+    H_init.slice(h).eye();
+    H_init.slice(h)(arma::span(0, 2), arma::span(0, 2)) = R_h;
+  }
+  H_init.slice(n_hyp - 1)(0, 3) = 10;
+
+  config_.inlier_epsilon = 5e-3;
+  config_.abort_epsilon = 5e-3;
+  config_.abort_min_inliers = n_pts_ / 4;
+  transforms::ICPTarget target(dst_, config_);
+
+  //! TEST CASE 1: lock-step results agree with one-at-a-time icp
+  arma::cube H_opt;
+  arma::uvec converged;
+  std::vector<transforms::ICPStats> stats;
+  size_t const n_converged = transforms::iterative_closest_points(src, target, H_init, config_,
+      H_opt, converged, &stats);
+  ASSERT_EQ(H_opt.n_slices, n_hyp);
+  ASSERT_EQ(stats.size(), n_hyp);
+  ASSERT_EQ(n_converged, static_cast<size_t>(arma::accu(converged)));
+  ASSERT_GT(n_converged, static_cast<size_t>(0));
+  for (size_t h = 0; h < n_hyp; ++h) {
+    arma::mat44 const H_h = H_init.slice(h);
+    arma::mat44 H_single;
+    transforms::ICPStats stats_single;
+    bool const converged_single = transforms::iterative_closest_point(src, target, H_h, config_,
+        H_single, &stats_single);
+    ASSERT_EQ(converged(h) != 0, converged_single);
+    ASSERT_EQ(stats[h].aborted, stats_single.aborted);
+    ASSERT_EQ(stats[h].counted_inliers, stats_single.counted_inliers);
+    if (converged_single) {
+      ASSERT_TRUE( arma::approx_equal(H_opt.slice(h), H_single, "absdiff", 1e-6) );
+      ASSERT_NEAR(static_cast<double>(stats[h].inliers),
+          static_cast<double>(stats_single.inliers), 2.);
+    }
+  }
+  ASSERT_TRUE(stats[n_hyp - 1].aborted);
+
+  //! TEST CASE 2: configurations without lock step run the hypotheses one at a time
+  config_.anderson_depth = 3;
+  size_t const n_converged_seq = transforms::iterative_closest_points(src, target, H_init, config_,
+      H_opt, converged, &stats);
+  ASSERT_EQ(n_converged_seq, static_cast<size_t>(arma::accu(converged)));
+  arma::mat44 const H_0 = H_init.slice(0);
+  arma::mat44 H_single;
+  transforms::iterative_closest_point(src, target, H_0, config_, H_single);
+  ASSERT_TRUE( arma::approx_equal(H_opt.slice(0), H_single, "absdiff", FLOAT_TOL) );
+}
+
+//! speed and accuracy of approximate nearest-neighbor matches; disabled by default, run with
+//! `icp_test --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*`
+TEST_F(ICPTest, DISABLED_BenchmarkApproximateNeighbors) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  size_t const n_reps = 3;
+
+  arma::mat33 R;
+  make_euler(0.1, -0.05, 0.033, R);
+  arma::vec3 const t = {0.1, -0.05, 0.08};
+  arma::mat44 const H_init(arma::fill::eye);
+
+  for (size_t const n_pts : {10000, 100000}) {
+    //! structured scene; the source is resampled from the same surfaces, so there are no exact
+    //! correspondences and approximate matches can change the result
+    arma::mat dst, resampled;
+    make_box_scene(n_pts, dst);
+    make_box_scene(n_pts, resampled);
+    arma::mat const src = R.t() * (resampled - arma::repmat(t, 1, n_pts));
+
+    transforms::ICPConfig config;
+    config.max_its = 100;
+    config.tolerance = 1e-7;
+    config.reject_ratio = 0.1;
+    transforms::ICPTarget target_exact(dst, config);
+    config.nn_epsilon = 1;
+    transforms::ICPTarget target_approx(dst, config);
+
+    //! reference: exact matches from the same (mlpack) searcher
+    config.nn_epsilon = 0;
+    arma::mat44 H_ref;
+    ASSERT_TRUE( transforms::iterative_closest_point(src, target_approx, H_init, config,
+          H_ref) );
+
+    std::cout << "points: " << n_pts << std::endl;
+    auto report = [&](std::string const & name, transforms::ICPTarget & target) {
+      arma::mat44 H_opt;
+      transforms::ICPStats stats;
+      bool converged = false;
+      auto const start = std::chrono::steady_clock::now();
+      for (size_t r = 0; r < n_reps; ++r) {
+        converged = transforms::iterative_closest_point(src, target, H_init, config, H_opt,
+            &stats);
+      }
+      std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+      arma::mat33 const R_opt = H_opt(arma::span(0, 2), arma::span(0, 2));
+      arma::vec3 const t_opt = H_opt(arma::span(0, 2), 3);
+      std::cout << "  " << name << ": time (s) " << elapsed.count() / static_cast<double>(n_reps) <<
+        ", converged " << converged << ", iterations " << stats.iterations <<
+        ", rotation error " << arma::norm(R_opt - R, "fro") <<
+        ", translation error " << arma::norm(t_opt - t) <<
+        ", difference from exact " << arma::norm(H_opt - H_ref, "fro") << std::endl;
+    };
+    report("ParallelSearcher, exact", target_exact);
+    for (double const nn_epsilon : {0., 0.1, 0.5, 1., 2.}) {
+      config.nn_epsilon = nn_epsilon;
+      report("KDTreeSearcher, nn_epsilon = " + std::to_string(nn_epsilon), target_approx);
+    }
+  }
+}
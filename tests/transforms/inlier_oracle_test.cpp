@@ -0,0 +1,158 @@
+//! c/c++ headers
+#include <vector>
+//! googletest
+#include "gtest/gtest.h"
+//! dependency headers
+#include "TestData.h"  // unit test configuration data (generated by CMake)
+#include "transforms/icp/icp.hpp"  // for KDTreeSearcher definition (reference results)
+//! unit-under-test header
+#include "transforms/common/inlier_oracle.hpp"
+
+//! The fixture for testing class InlierOracle.
+class InlierOracleTest : public ::testing::Test {
+ protected:
+   /**
+    * constants for test
+    */
+   // You can remove any or all of the following functions if their bodies would
+   // be empty.
+
+   InlierOracleTest() {
+     // You can do set-up work for each test here.
+   }
+
+   ~InlierOracleTest() override {
+     // You can do clean-up work that doesn't throw exceptions here.
+   }
+
+   // If the constructor and destructor are not enough for setting up
+   // and cleaning up each test, you can define the following methods:
+
+   void SetUp() override {
+     // Code here will be called immediately after the constructor (right
+     // before each test).
+   }
+
+   void TearDown() override {
+     // Code here will be called immediately after each test (right
+     // before the destructor).
+   }
+
+   // Class members declared here can be used by all tests in the test suite
+   // for Foo.
+};
+
+TEST_F(InlierOracleTest, MatchesKDTree) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  size_t const n_pts = 2000;
+  size_t const n_queries = 4000;
+  double const epsilon = 0.1;
+  arma::mat const pts = arma::randn(3, n_pts);
+
+  //! queries: a quarter anywhere (including outside the bounding box), the rest near target points
+  //! and half of those just inside or just outside epsilon of a target point, where the exact
+  //! fallback decides
+  arma::mat queries = 2 * arma::randn(3, n_queries);
+  queries.cols(n_queries / 4, n_queries / 2 - 1) = pts.head_cols(n_queries / 4) +
+    0.05 * arma::randn(3, n_queries / 4);
+  arma::mat dirs = arma::normalise(arma::randn(3, n_queries / 2));
+  arma::rowvec const scale = epsilon * (1 + 1e-6 * arma::sign(arma::randn(1, n_queries / 2)));
+  dirs.each_row() %= scale;
+  queries.tail_cols(n_queries / 2) = arma::repmat(pts.head_cols(n_queries / 4), 1, 2) + dirs;
+
+  //! reference: exact nearest-neighbor distances from the KD-tree
+  transforms::KDTreeSearcher searcher(pts);
+  arma::Mat<size_t> kd_neighbors;
+  arma::mat kd_distances;
+  searcher.Search(queries, 1, kd_neighbors, kd_distances);
+  size_t const n_expected = arma::accu(kd_distances <= epsilon);
+
+  //! TEST CASE 1: nominal resolution
+  transforms::InlierOracle const oracle(pts, epsilon);
+  ASSERT_EQ(oracle.size(), n_pts);
+  ASSERT_DOUBLE_EQ(oracle.epsilon(), epsilon);
+  ASSERT_GT(oracle.num_inside_cells(), static_cast<size_t>(0));
+  ASSERT_GT(oracle.num_boundary_cells(), static_cast<size_t>(0));
+  ASSERT_EQ(oracle.count_inliers(queries), n_expected);
+  for (size_t i = 0; i < n_queries; ++i) {
+    ASSERT_EQ(oracle.is_inlier(queries.colptr(i)), kd_distances(0, i) <= epsilon);
+  }
+  ASSERT_GT(n_expected, static_cast<size_t>(0));
+  ASSERT_LT(n_expected, n_queries);
+
+  //! TEST CASE 2: a finer grid gives the same answers
+  transforms::InlierOracle const fine(pts, epsilon, 4);
+  ASSERT_EQ(fine.count_inliers(queries), n_expected);
+}
+
+TEST_F(InlierOracleTest, FusedTransformAndCount) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  size_t const n_pts = 1000;
+  size_t const n_src = 777;  //! not a multiple of the block size
+  double const epsilon = 0.1;
+  arma::mat const pts = arma::randn(3, n_pts);
+  arma::mat const src = pts.head_cols(n_src) + 0.1 * arma::randn(3, n_src);
+
+  //! source is rotated and translated away from the target; the transformation brings it back
+  arma::vec3 const axis = arma::normalise(arma::vec3({1, 2, 3}));
+  arma::mat33 const K = {{0, -axis(2), axis(1)}, {axis(2), 0, -axis(0)}, {-axis(1), axis(0), 0}};
+  arma::mat33 const R = arma::expmat(0.3 * K);
+  arma::vec3 const t = {0.5, -0.2, 1.};
+  arma::mat const src_moved = R.t() * (src.each_col() - t);
+
+  transforms::InlierOracle const oracle(pts, epsilon);
+  arma::mat const src_xform = R * src_moved + arma::repmat(t, 1, n_src);
+  size_t const n_expected = oracle.count_inliers(src_xform);
+  ASSERT_GT(n_expected, static_cast<size_t>(0));
+  ASSERT_LT(n_expected, n_src);
+
+  //! TEST CASE 1: count only
+  ASSERT_EQ(oracle.count_inliers(R, t, src_moved), n_expected);
+
+  //! TEST CASE 2: count and bitmask
+  std::vector<uint64_t> mask((n_src + 63) / 64, ~static_cast<uint64_t>(0));
+  ASSERT_EQ(oracle.count_inliers(R, t, src_moved, mask.data()), n_expected);
+  for (size_t i = 0; i < n_src; ++i) {
+    ASSERT_EQ(((mask[i / 64] >> (i % 64)) & 1) != 0, oracle.is_inlier(src_xform.colptr(i)));
+  }
+  ASSERT_EQ(mask.back() >> (n_src % 64), static_cast<uint64_t>(0));
+}
+
+TEST_F(InlierOracleTest, DegenerateInputs) {
+  arma::mat const queries(3, 4, arma::fill::zeros);
+
+  //! TEST CASE 1: an empty oracle never matches
+  transforms::InlierOracle const empty;
+  ASSERT_EQ(empty.count_inliers(queries), static_cast<size_t>(0));
+  transforms::InlierOracle const no_targets(arma::mat(3, 0), 0.1);
+  ASSERT_EQ(no_targets.size(), static_cast<size_t>(0));
+  ASSERT_EQ(no_targets.count_inliers(queries), static_cast<size_t>(0));
+
+  //! TEST CASE 2: a single target point
+  arma::mat const single(3, 1, arma::fill::zeros);
+  transforms::InlierOracle const one(single, 0.1);
+  arma::vec3 pt = {0.0999, 0, 0};
+  ASSERT_TRUE(one.is_inlier(pt.memptr()));
+  pt = {0.1001, 0, 0};
+  ASSERT_FALSE(one.is_inlier(pt.memptr()));
+  pt = {0.05, 0.05, 0.05};
+  ASSERT_TRUE(one.is_inlier(pt.memptr()));
+  pt = {0.06, 0.06, 0.06};
+  ASSERT_FALSE(one.is_inlier(pt.memptr()));
+
+  //! TEST CASE 3: planar targets (zero extent along one axis) agree with the KD-tree
+  arma::arma_rng::set_seed(11011);
+  arma::mat pts = arma::randu(3, 500);
+  pts.row(2).zeros();
+  arma::mat planar_queries = arma::randu(3, 1000);
+  planar_queries.row(2) = 0.2 * planar_queries.row(2) - 0.1;
+  transforms::KDTreeSearcher searcher(pts);
+  arma::Mat<size_t> kd_neighbors;
+  arma::mat kd_distances;
+  searcher.Search(planar_queries, 1, kd_neighbors, kd_distances);
+  transforms::InlierOracle const planar(pts, 0.05);
+  ASSERT_EQ(planar.count_inliers(planar_queries),
+      static_cast<size_t>(arma::accu(kd_distances <= 0.05)));
+}
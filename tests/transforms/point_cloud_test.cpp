@@ -0,0 +1,122 @@
+//! c/c++ headers
+#include <cstdint>
+#include <vector>
+//! googletest
+#include "gtest/gtest.h"
+//! dependency headers
+#include "TestData.h"  // unit test configuration data (generated by CMake)
+//! unit-under-test header
+#include "transforms/common/point_cloud.hpp"
+
+//! The fixture for testing class BasicPointCloud.
+class PointCloudTest : public ::testing::Test {
+ protected:
+   /**
+    * constants for test
+    */
+   // You can remove any or all of the following functions if their bodies would
+   // be empty.
+
+   PointCloudTest() {
+     // You can do set-up work for each test here.
+   }
+
+   ~PointCloudTest() override {
+     // You can do clean-up work that doesn't throw exceptions here.
+   }
+
+   // If the constructor and destructor are not enough for setting up
+   // and cleaning up each test, you can define the following methods:
+
+   void SetUp() override {
+     // Code here will be called immediately after the constructor (right
+     // before each test).
+   }
+
+   void TearDown() override {
+     // Code here will be called immediately after each test (right
+     // before the destructor).
+   }
+
+   // Class members declared here can be used by all tests in the test suite
+   // for Foo.
+};
+
+namespace {
+bool is_aligned(void const * p) {
+  return reinterpret_cast<uintptr_t>(p) % transforms::point_cloud_alignment == 0;
+}
+}  // namespace
+
+TEST_F(PointCloudTest, ConvertAndView) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  size_t const n_pts = 101;  //! not a multiple of the alignment block
+  arma::mat const pts = arma::randn(3, n_pts);
+
+  //! TEST CASE 1: round trip through double storage is exact; coordinate arrays are aligned
+  transforms::PointCloud const cloud(pts);
+  ASSERT_EQ(cloud.size(), n_pts);
+  ASSERT_TRUE(is_aligned(cloud.x()));
+  ASSERT_TRUE(is_aligned(cloud.y()));
+  ASSERT_TRUE(is_aligned(cloud.z()));
+  for (size_t i = 0; i < n_pts; ++i) {
+    ASSERT_EQ(cloud.x()[i], pts(0, i));
+    ASSERT_EQ(cloud.y()[i], pts(1, i));
+    ASSERT_EQ(cloud.z()[i], pts(2, i));
+  }
+  ASSERT_TRUE( arma::all(arma::vectorise(cloud.to_mat() == pts)) );
+
+  //! TEST CASE 2: float storage rounds to single precision
+  transforms::PointCloudF const cloud_f(pts);
+  ASSERT_EQ(cloud_f.size(), n_pts);
+  ASSERT_TRUE(is_aligned(cloud_f.z()));
+  ASSERT_TRUE( arma::approx_equal(cloud_f.to_mat(), pts, "reldiff", 1e-6) );
+
+  //! TEST CASE 3: views do not copy; sub-views are clipped to the cloud
+  transforms::PointCloudView<double> const view = cloud.view();
+  ASSERT_EQ(view.x(), cloud.x());
+  transforms::PointCloudView<double> const tail = view.subview(n_pts - 5, 10);
+  ASSERT_EQ(tail.size(), static_cast<size_t>(5));
+  ASSERT_EQ(tail.y()[0], pts(1, n_pts - 5));
+  ASSERT_TRUE(view.subview(n_pts + 1, 3).empty());
+
+  //! TEST CASE 4: index views read through to the cloud, and gather into contiguous storage
+  std::vector<size_t> const idx = {7, 0, 100, 7};
+  transforms::IndexedPointCloudView<double> const selected(view, idx);
+  ASSERT_EQ(selected.size(), idx.size());
+  ASSERT_EQ(selected.z(2), pts(2, 100));
+  transforms::PointCloud const gathered(selected);
+  arma::mat const gathered_pts = gathered.to_mat();
+  for (size_t i = 0; i < idx.size(); ++i) {
+    ASSERT_TRUE( arma::all(gathered_pts.col(i) == pts.col(idx[i])) );
+  }
+}
+
+TEST_F(PointCloudTest, Resize) {
+  arma::mat const pts = arma::reshape(arma::regspace(1, 3 * 20), 3, 20);
+  transforms::PointCloud cloud(pts);
+
+  //! TEST CASE 1: shrinking keeps the leading points
+  cloud.resize(9);
+  ASSERT_EQ(cloud.size(), static_cast<size_t>(9));
+  ASSERT_TRUE( arma::all(arma::vectorise(cloud.to_mat() == pts.head_cols(9))) );
+
+  //! TEST CASE 2: growing keeps the points and adds points at the origin
+  cloud.resize(40);
+  arma::mat const grown = cloud.to_mat();
+  ASSERT_TRUE( arma::all(arma::vectorise(grown.head_cols(9) == pts.head_cols(9))) );
+  ASSERT_TRUE( arma::all(arma::vectorise(grown.tail_cols(31) == 0)) );
+  ASSERT_TRUE(is_aligned(cloud.y()));
+
+  //! TEST CASE 3: copies own their (aligned) storage
+  transforms::PointCloud const copy = cloud;
+  ASSERT_NE(copy.x(), cloud.x());
+  ASSERT_TRUE(is_aligned(copy.z()));
+  ASSERT_TRUE( arma::all(arma::vectorise(copy.to_mat() == grown)) );
+
+  //! TEST CASE 4: empty clouds
+  transforms::PointCloud const empty;
+  ASSERT_TRUE(empty.empty());
+  ASSERT_EQ(empty.to_mat().n_cols, static_cast<size_t>(0));
+}
@@ -1,8 +1,10 @@
 //! c/c++ headers
+#include <algorithm>
 #include <string>
 #include <fstream>
 #include <streambuf>
 #include <utility>
+#include <vector>
 //! googletest
 #include "gtest/gtest.h"
 //! dependency headers
@@ -129,3 +131,162 @@ TEST_F(SVDTest, Correspondences) {
   arma::mat const src_xform( R_opt * src_before + arma::repmat(t_opt, 1, dst.n_cols) );
   ASSERT_TRUE( arma::approx_equal(dst, src_xform, "absdiff", FLOAT_TOL) );
 }
+
+TEST_F(SVDTest, WeightedCorrespondences) {
+  arma::arma_rng::set_seed(11011);
+  double const & spread = 10;
+  size_t const n_pts = 30;
+  size_t const n_outliers = 10;
+
+  //! target points far from the origin (exercises the single-pass accumulation)
+  arma::mat const dst = spread * arma::randn(3, n_pts) + 1e4;
+
+  //! yaw, pitch, roll
+  arma::mat33 R;
+  make_euler(M_PI / 5, -M_PI / 7, M_PI / 3, R);
+  arma::vec3 const t = {-4, 1, 7};
+
+  //! source points: R.t() * (dst - t); the last few are corrupted
+  arma::mat src = R.t() * (dst - arma::repmat(t, 1, n_pts));
+  src.tail_cols(n_outliers) += spread * arma::randn(3, n_outliers);
+
+  //! correspondences: identity mapping, zero weight on corrupted points
+  cor::correspondences_t corrs;
+  for (size_t i = 0; i < n_pts; ++i) {
+    corrs[std::make_pair(i, i)] = (i < n_pts - n_outliers) ? 0.5 : 0.;
+  }
+
+  //! TEST CASE 1: weighted fit ignores corrupted points and recovers the transformation
+  arma::mat44 H_opt;
+  ASSERT_TRUE( transforms::best_fit_transform(src, dst, corrs, H_opt, true) );
+  arma::mat33 const R_opt = H_opt(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 const t_opt = H_opt(arma::span(0, 2), 3);
+  ASSERT_TRUE( arma::approx_equal(R_opt, R, "absdiff", FLOAT_TOL) );
+  ASSERT_TRUE( arma::approx_equal(t_opt, t, "absdiff", 1e4 * FLOAT_TOL) );
+  ASSERT_NEAR( arma::det(R_opt), 1, FLOAT_TOL );
+
+  //! TEST CASE 2: unweighted fit (weights ignored) is pulled off by corrupted points
+  ASSERT_TRUE( transforms::best_fit_transform(src, dst, corrs, H_opt) );
+  arma::mat33 const R_unw = H_opt(arma::span(0, 2), arma::span(0, 2));
+  ASSERT_FALSE( arma::approx_equal(R_unw, R, "absdiff", 1e-3) );
+  ASSERT_NEAR( arma::det(R_unw), 1, FLOAT_TOL );
+}
+
+TEST_F(SVDTest, Batched) {
+  arma::arma_rng::set_seed(11011);
+  size_t const n_probs = 37;  //! not a multiple of the SIMD width
+  size_t const n_pts = 6;
+  size_t const n_valid = 4;  //! remaining points of each problem are zero-weight padding
+
+  //! problems in structure-of-arrays layout: (problem, point, coordinate)
+  arma::cube src(n_probs, n_pts, 3), dst(n_probs, n_pts, 3);
+  arma::mat weights(n_probs, n_pts, arma::fill::zeros);
+  weights.head_cols(n_valid) = arma::randu(n_probs, n_valid) + 0.1;
+  arma::cube R_true(3, 3, n_probs);
+  arma::mat t_true(3, n_probs);
+  for (size_t b = 0; b < n_probs; ++b) {
+    arma::mat33 R;
+    make_euler(M_PI * arma::randu(), M_PI / 2 * arma::randu(), M_PI * arma::randu(), R);
+    arma::vec3 const t = 5 * arma::randn(3);
+    arma::mat const s = arma::randn(3, n_pts) + 100 * (b % 3);
+    arma::mat d = R * s + arma::repmat(t, 1, n_pts);
+    d.tail_cols(n_pts - n_valid) += arma::randn(3, n_pts - n_valid);
+    for (size_t r = 0; r < 3; ++r) {
+      src.slice(r).row(b) = s.row(r);
+      dst.slice(r).row(b) = d.row(r);
+    }
+    R_true.slice(b) = R;
+    t_true.col(b) = t;
+  }
+
+  //! TEST CASE 1: weighted batch recovers every transformation and agrees with the scalar solver
+  arma::cube R_opt;
+  arma::mat t_opt;
+  ASSERT_TRUE( transforms::best_fit_transforms(src, dst, weights, R_opt, t_opt) );
+  ASSERT_EQ(R_opt.n_slices, n_probs);
+  ASSERT_EQ(t_opt.n_cols, n_probs);
+  for (size_t b = 0; b < n_probs; ++b) {
+    ASSERT_TRUE( arma::approx_equal(R_opt.slice(b), R_true.slice(b), "absdiff", FLOAT_TOL) );
+    ASSERT_TRUE( arma::approx_equal(t_opt.col(b), t_true.col(b), "absdiff", 100 * FLOAT_TOL) );
+
+    arma::mat src_b(3, n_pts), dst_b(3, n_pts);
+    for (size_t r = 0; r < 3; ++r) {
+      src_b.row(r) = src.slice(r).row(b);
+      dst_b.row(r) = dst.slice(r).row(b);
+    }
+    cor::correspondences_t corrs;
+    for (size_t k = 0; k < n_pts; ++k) {
+      corrs[std::make_pair(k, k)] = weights(b, k);
+    }
+    arma::mat44 H_opt;
+    ASSERT_TRUE( transforms::best_fit_transform(src_b, dst_b, corrs, H_opt, true) );
+    ASSERT_TRUE( arma::approx_equal(R_opt.slice(b), H_opt(arma::span(0, 2), arma::span(0, 2)),
+          "absdiff", FLOAT_TOL) );
+  }
+
+  //! TEST CASE 2: an empty batch is valid
+  ASSERT_TRUE( transforms::best_fit_transforms(arma::cube(0, n_pts, 3), arma::cube(0, n_pts, 3),
+        arma::mat(), R_opt, t_opt) );
+  ASSERT_EQ(R_opt.n_slices, static_cast<size_t>(0));
+}
+
+TEST_F(SVDTest, ClosestRotation) {
+  arma::arma_rng::set_seed(11011);
+
+  //! reference from LAPACK: R = U * diag(1, 1, det(U * V.t())) * V.t() for A = U * S * V.t()
+  auto const reference = [](arma::mat33 const & A, arma::mat33 & R) {
+    arma::mat33 U, V;
+    arma::vec3 s;
+    arma::svd(U, s, V, A);
+    arma::mat33 D(arma::fill::eye);
+    D(2, 2) = arma::det(U * V.t()) < 0 ? -1 : 1;
+    R = U * D * V.t();
+  };
+
+  //! random matrices (both signs of the determinant), then degenerate ones
+  size_t const n_random = 200;
+  std::vector<arma::mat33> inputs;
+  for (size_t i = 0; i < n_random; ++i) {
+    inputs.push_back(arma::mat33(arma::randn(3, 3)));
+  }
+  arma::mat33 const B = arma::randn(3, 3);
+  inputs.push_back(arma::mat33(arma::zeros(3, 3)));  //! zero
+  inputs.push_back(arma::mat33(arma::eye(3, 3)));  //! identity
+  inputs.push_back(arma::mat33(-arma::eye(3, 3)));  //! point reflection
+  inputs.push_back(arma::mat33(arma::diagmat(arma::vec3({3, 2, -1}))));  //! plane reflection
+  inputs.push_back(arma::mat33(B.col(0) * B.col(1).t()));  //! rank 1
+  inputs.push_back(arma::mat33(B.col(0) * B.col(1).t() + B.col(2) * B.col(0).t()));  //! rank 2
+  inputs.push_back(arma::mat33(1e-12 * B));  //! tiny
+  inputs.push_back(arma::mat33(1e12 * B));  //! huge
+
+  arma::cube A(3, 3, inputs.size());
+  for (size_t b = 0; b < inputs.size(); ++b) {
+    A.slice(b) = inputs[b];
+  }
+  arma::cube R_batch;
+  transforms::closest_rotations(A, R_batch);
+  ASSERT_EQ(R_batch.n_slices, inputs.size());
+
+  for (size_t b = 0; b < inputs.size(); ++b) {
+    arma::mat33 R, R_ref;
+    transforms::closest_rotation(inputs[b], R);
+    reference(inputs[b], R_ref);
+
+    //! TEST CASE 1: result is a proper rotation
+    ASSERT_TRUE( arma::approx_equal(R.t() * R, arma::eye(3, 3), "absdiff", FLOAT_TOL) );
+    ASSERT_NEAR( arma::det(R), 1, FLOAT_TOL );
+
+    //! TEST CASE 2: result is as good as LAPACK's (degenerate inputs have many optimal rotations)
+    double const scale = std::max(1., arma::norm(inputs[b], "fro"));
+    ASSERT_NEAR( arma::trace(R.t() * inputs[b]), arma::trace(R_ref.t() * inputs[b]),
+        scale * FLOAT_TOL );
+
+    //! TEST CASE 3: random inputs have a unique optimum, which matches LAPACK's
+    if (b < n_random) {
+      ASSERT_TRUE( arma::approx_equal(R, R_ref, "absdiff", FLOAT_TOL) );
+    }
+
+    //! TEST CASE 4: SIMD batch agrees with the scalar kernel
+    ASSERT_TRUE( arma::approx_equal(R_batch.slice(b), R, "absdiff", FLOAT_TOL) );
+  }
+}
@@ -68,3 +68,28 @@ void find_euler_angles(arma::mat33 const & R, arma::vec3 & angles, bool flip_pit
     angles(2) = std::atan2(R(1, 0) / std::cos(angles(0)), R(0, 0) / std::cos(angles(0)));
   }
 }
+
+/**
+ * @brief Sample points uniformly on the faces of a 4x2x1 box (a simple structured scene)
+ *
+ * @param [in] n_pts number of points (faces are visited in turn)
+ * @param [out] pts sampled points (columnar)
+ * @return
+ *
+ * @note uses armadillo's random number generator; seed it for repeatability
+ */
+void make_box_scene(size_t const & n_pts, arma::mat & pts) {
+  pts.set_size(3, n_pts);
+  for (size_t i = 0; i < n_pts; ++i) {
+    arma::vec3 const u(arma::fill::randu);
+    double const a = 4 * u(0), b = 2 * u(1), c = u(2);
+    switch (i % 6) {
+      case 0: pts.col(i) = arma::vec3({a, b, 0}); break;
+      case 1: pts.col(i) = arma::vec3({a, b, 1}); break;
+      case 2: pts.col(i) = arma::vec3({a, 0, c}); break;
+      case 3: pts.col(i) = arma::vec3({a, 2, c}); break;
+      case 4: pts.col(i) = arma::vec3({0, b, c}); break;
+      default: pts.col(i) = arma::vec3({4, b, c}); break;
+    }
+  }
+}
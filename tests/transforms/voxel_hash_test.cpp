@@ -0,0 +1,187 @@
+//! c/c++ headers
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <vector>
+//! googletest
+#include "gtest/gtest.h"
+//! dependency headers
+#include "TestData.h"  // unit test configuration data (generated by CMake)
+#include "transforms/icp/icp.hpp"  // for KDTreeSearcher definition (reference results)
+//! unit-under-test header
+#include "transforms/common/voxel_hash.hpp"
+
+//! The fixture for testing class VoxelHash.
+class VoxelHashTest : public ::testing::Test {
+ protected:
+   /**
+    * constants for test
+    */
+   // You can remove any or all of the following functions if their bodies would
+   // be empty.
+
+   VoxelHashTest() {
+     // You can do set-up work for each test here.
+   }
+
+   ~VoxelHashTest() override {
+     // You can do clean-up work that doesn't throw exceptions here.
+   }
+
+   // If the constructor and destructor are not enough for setting up
+   // and cleaning up each test, you can define the following methods:
+
+   void SetUp() override {
+     // Code here will be called immediately after the constructor (right
+     // before each test).
+   }
+
+   void TearDown() override {
+     // Code here will be called immediately after each test (right
+     // before the destructor).
+   }
+
+   // Class members declared here can be used by all tests in the test suite
+   // for Foo.
+};
+
+TEST_F(VoxelHashTest, MatchesKDTreeWithinRadius) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  size_t const n_pts = 5000;
+  size_t const n_queries = 2000;
+  double const radius = 0.25;
+  arma::mat const pts = 2 * arma::randn(3, n_pts);
+  //! queries: half near indexed points, half anywhere (including outside the bounding box)
+  arma::mat queries = 3 * arma::randn(3, n_queries);
+  queries.head_cols(n_queries / 2) = pts.head_cols(n_queries / 2) +
+    0.1 * arma::randn(3, n_queries / 2);
+
+  transforms::VoxelHash const voxels(pts, radius);
+  ASSERT_EQ(voxels.size(), n_pts);
+  ASSERT_GT(voxels.num_cells(), static_cast<size_t>(0));
+
+  //! reference: exact nearest neighbors from the KD-tree
+  transforms::KDTreeSearcher searcher(pts);
+  arma::Mat<size_t> kd_neighbors;
+  arma::mat kd_distances;
+  searcher.Search(queries, 1, kd_neighbors, kd_distances);
+
+  //! TEST CASE 1: batched search agrees with the KD-tree within the radius, and reports no match
+  //! beyond it
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  size_t const n_found = voxels.search(queries, neighbors, distances);
+  size_t n_expected = 0;
+  for (size_t i = 0; i < n_queries; ++i) {
+    if (kd_distances(0, i) <= radius) {
+      ++n_expected;
+      ASSERT_EQ(neighbors(0, i), kd_neighbors(0, i));
+      ASSERT_NEAR(distances(0, i), kd_distances(0, i), FLOAT_TOL);
+    } else {
+      ASSERT_EQ(neighbors(0, i), n_pts);
+      ASSERT_EQ(distances(0, i), std::numeric_limits<double>::infinity());
+    }
+  }
+  ASSERT_EQ(n_found, n_expected);
+  ASSERT_GT(n_found, static_cast<size_t>(0));
+  ASSERT_LT(n_found, n_queries);
+
+  //! TEST CASE 2: counting within a smaller radius agrees with the KD-tree
+  double const count_radius = 0.5 * radius;
+  size_t const n_within = arma::accu(kd_distances <= count_radius);
+  ASSERT_EQ(voxels.count_within(queries, count_radius), n_within);
+  for (size_t i = 0; i < n_queries; ++i) {
+    ASSERT_EQ(voxels.any_within(queries.colptr(i), count_radius),
+        kd_distances(0, i) <= count_radius);
+  }
+
+  //! TEST CASE 3: all points within the radius agree with a brute-force scan
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < 100; ++i) {
+    indices.clear();
+    voxels.within(queries.colptr(i), radius, indices);
+    arma::rowvec const d = arma::sqrt(arma::sum(arma::square(
+            pts.each_col() - queries.col(i)), 0));
+    arma::uvec const expected = arma::find(d <= radius);
+    std::sort(indices.begin(), indices.end());
+    ASSERT_EQ(indices.size(), expected.n_elem);
+    for (size_t j = 0; j < indices.size(); ++j) {
+      ASSERT_EQ(indices[j], expected(j));
+    }
+  }
+}
+
+TEST_F(VoxelHashTest, DegenerateInputs) {
+  //! TEST CASE 1: an empty index never matches
+  transforms::VoxelHash const empty;
+  arma::mat const queries(3, 4, arma::fill::zeros);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  ASSERT_EQ(empty.search(queries, neighbors, distances), static_cast<size_t>(0));
+  ASSERT_EQ(empty.count_within(queries, 1), static_cast<size_t>(0));
+
+  //! TEST CASE 2: planar points (zero extent along one axis) are indexed and found exactly
+  arma::arma_rng::set_seed(11011);
+  arma::mat pts = arma::randu(3, 100);
+  pts.row(2).zeros();
+  transforms::VoxelHash const planar(pts, 0.1);
+  ASSERT_EQ(planar.search(pts, neighbors, distances), pts.n_cols);
+  for (size_t i = 0; i < pts.n_cols; ++i) {
+    ASSERT_EQ(neighbors(0, i), i);
+    ASSERT_EQ(distances(0, i), 0);
+  }
+}
+
+//! timing comparison with the KD-tree; disabled by default, run with
+//! `voxel_hash_test --gtest_also_run_disabled_tests --gtest_filter=*Benchmark*`
+TEST_F(VoxelHashTest, DISABLED_Benchmark) {
+  //! set the random seed for repeatability
+  arma::arma_rng::set_seed(11011);
+  double const radius = 0.05;
+  size_t const n_reps = 5;
+  //! average wall-clock time (seconds) of `n_reps` calls
+  auto time_it = [&](auto const & f) {
+    auto const start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < n_reps; ++r) {
+      f();
+    }
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>(n_reps);
+  };
+
+  for (size_t const n_pts : {10000, 100000, 1000000}) {
+    //! same kind of cloud as the tests above; queries are perturbed copies of the points, so most
+    //! (but not all) of them have a point within the radius
+    arma::mat const pts = 2 * arma::randn(3, n_pts);
+    arma::mat const queries = pts + radius * arma::randn(3, n_pts);
+
+    double const t_build_voxels = time_it([&]() { transforms::VoxelHash const v(pts, radius); });
+    double const t_build_kd = time_it([&]() { transforms::KDTreeSearcher const s(pts); });
+
+    transforms::VoxelHash const voxels(pts, radius);
+    transforms::KDTreeSearcher searcher(pts);
+    arma::Mat<size_t> neighbors, kd_neighbors;
+    arma::mat distances, kd_distances;
+    size_t n_found = 0, n_counted = 0;
+    double const t_search_voxels = time_it([&]() {
+        n_found = voxels.search(queries, neighbors, distances); });
+    double const t_count_voxels = time_it([&]() {
+        n_counted = voxels.count_within(queries, radius); });
+    double const t_search_kd = time_it([&]() {
+        searcher.Search(queries, 1, kd_neighbors, kd_distances); });
+
+    //! both indices must agree on the matches being timed
+    size_t const n_kd = static_cast<size_t>(arma::accu(kd_distances <= radius));
+    ASSERT_EQ(n_found, n_kd);
+    ASSERT_EQ(n_counted, n_kd);
+
+    std::cout << "points/queries: " << n_pts << ", within radius: " << n_kd << std::endl;
+    std::cout << "  build (s):  VoxelHash " << t_build_voxels << ", KDTreeSearcher " <<
+      t_build_kd << std::endl;
+    std::cout << "  query (s):  VoxelHash::search " << t_search_voxels <<
+      ", VoxelHash::count_within " << t_count_voxels << ", KDTreeSearcher::Search " <<
+      t_search_kd << std::endl;
+  }
+}
@@ -0,0 +1,184 @@
+#pragma once
+//! c/c++ headers
+#include <cstdint>
+#include <utility>
+#include <vector>
+//! dependency headers
+#include <armadillo>
+//! project headers
+
+namespace transforms {
+/**
+ * @struct CellGrid
+ * @brief uniform grid of cubic cells over an axis-aligned box; cell coordinates are packed into
+ * 21 bits per axis
+ *
+ * @var CellGrid::origin
+ * minimum corner of the grid
+ * @var CellGrid::cell_size
+ * side of a cell
+ * @var CellGrid::dims
+ * number of cells along each axis
+ */
+struct CellGrid {
+  //! largest number of cells along an axis
+  static constexpr int64_t max_dim = (static_cast<int64_t>(1) << 21) - 1;
+
+  /** CellGrid::fit(pts, min_cell_size, margin)
+   * @brief fit the grid to the bounding box of a set of points
+   *
+   * @param[in] pts points (columnar, 3 rows, at least one column)
+   * @param[in] min_cell_size requested cell size; increased only if the box would need more than
+   * `max_dim` cells along an axis
+   * @param[in] margin distance by which the bounding box is grown on every side
+   * @return
+   */
+  void fit(arma::mat const & pts, double const & min_cell_size, double const & margin) noexcept;
+
+  /** CellGrid::cell_of(p, c)
+   * @brief cell coordinates of a point (not clamped to the grid)
+   *
+   * @param[in] p pointer to point (3 contiguous values)
+   * @param[in][out] c cell coordinates
+   * @return false if the point is more than one cell outside the grid (or not finite), true
+   * otherwise
+   */
+  bool cell_of(double const * p, int64_t c[3]) const noexcept;
+
+  /** CellGrid::contains(c)
+   * @brief check whether cell coordinates lie inside the grid
+   *
+   * @param[in] c cell coordinates
+   * @return true if inside, false otherwise
+   */
+  bool contains(int64_t const c[3]) const noexcept {
+    return c[0] >= 0 && c[0] < dims[0] && c[1] >= 0 && c[1] < dims[1] &&
+      c[2] >= 0 && c[2] < dims[2];
+  }
+
+  /** CellGrid::pack(ix, iy, iz)
+   * @brief pack (in-grid) cell coordinates into a single key
+   *
+   * @param[in] ix cell coordinate along x
+   * @param[in] iy cell coordinate along y
+   * @param[in] iz cell coordinate along z
+   * @return packed key
+   */
+  static uint64_t pack(int64_t const & ix, int64_t const & iy, int64_t const & iz) noexcept {
+    return (static_cast<uint64_t>(ix) << 42) | (static_cast<uint64_t>(iy) << 21) |
+      static_cast<uint64_t>(iz);
+  }
+
+  /** CellGrid::unpack(key, c)
+   * @brief inverse of `pack`
+   *
+   * @param[in] key packed key
+   * @param[in][out] c cell coordinates
+   * @return
+   */
+  static void unpack(uint64_t const & key, int64_t c[3]) noexcept {
+    c[0] = static_cast<int64_t>(key >> 42);
+    c[1] = static_cast<int64_t>((key >> 21) & static_cast<uint64_t>(max_dim));
+    c[2] = static_cast<int64_t>(key & static_cast<uint64_t>(max_dim));
+  }
+
+  /** CellGrid::morton(ix, iy, iz)
+   * @brief interleave the bits of (in-grid) cell coordinates into a Morton (z-order) key; cells
+   * that are close in space mostly have close keys
+   *
+   * @param[in] ix cell coordinate along x
+   * @param[in] iy cell coordinate along y
+   * @param[in] iz cell coordinate along z
+   * @return Morton key
+   */
+  static uint64_t morton(int64_t const & ix, int64_t const & iy, int64_t const & iz) noexcept {
+    return spread(ix) | (spread(iy) << 1) | (spread(iz) << 2);
+  }
+
+  /** CellGrid::spread(v)
+   * @brief insert two zero bits after each of the low 21 bits of a cell coordinate
+   *
+   * @param[in] v cell coordinate
+   * @return spread bits
+   */
+  static uint64_t spread(int64_t const & v) noexcept {
+    uint64_t x = static_cast<uint64_t>(v) & static_cast<uint64_t>(max_dim);
+    x = (x | (x << 32)) & 0x001f00000000ffffull;
+    x = (x | (x << 16)) & 0x001f0000ff0000ffull;
+    x = (x | (x << 8)) & 0x100f00f00f00f00full;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ull;
+    x = (x | (x << 2)) & 0x1249249249249249ull;
+    return x;
+  }
+
+  arma::vec3 origin;
+  double cell_size = 0;
+  int64_t dims[3] = {0, 0, 0};
+};
+
+/**
+ * @class CellTable
+ * @brief open-addressing hash table (linear probing, at most half full) from packed cell keys to
+ * [begin, end) ranges of a cell-sorted array
+ */
+class CellTable {
+ public:
+   /**
+    * @struct Cell
+    * @brief table entry: 16 bytes
+    */
+   struct Cell {
+     uint64_t key;
+     uint32_t begin;
+     uint32_t end;
+   };
+
+   /** CellTable::build(cells)
+    * @brief (re)build the table
+    *
+    * @param[in] cells entries to insert (keys must be unique)
+    * @return
+    */
+   void build(std::vector<Cell> const & cells) noexcept;
+
+   /** CellTable::find(key)
+    * @brief look up an entry
+    *
+    * @param[in] key packed cell coordinates
+    * @return pointer to entry, or nullptr if there is none
+    */
+   Cell const * find(uint64_t const & key) const noexcept;
+
+   /** CellTable::size()
+    * @brief get number of entries
+    *
+    * @param[in]
+    * @return number of entries
+    */
+   size_t size() const noexcept { return size_; }
+
+ private:
+   std::vector<Cell> slots_;  //! power-of-two number of slots
+   size_t size_ = 0;  //! number of entries
+   int shift_ = 64;  //! 64 - log2(no. of slots), for multiplicative hashing
+};
+
+/**
+ * @brief sort (key, column) pairs; chunks are sorted in parallel, then merged pairwise
+ *
+ * @param[in][out] items pairs to sort
+ * @return
+ */
+void parallel_sort(std::vector<std::pair<uint64_t, uint32_t>> & items) noexcept;
+
+/**
+ * @brief order of points along a Morton (z-order) curve over their bounding box, so that points
+ * close in space are mostly close in the order
+ *
+ * @param[in] pts points (columnar, 3 rows)
+ * @param[in][out] order columns of `pts` in Morton order (points in the same finest cell keep
+ * their relative order)
+ * @return
+ */
+void morton_order(arma::mat const & pts, std::vector<size_t> & order) noexcept;
+}  // namespace transforms
@@ -0,0 +1,121 @@
+#pragma once
+//! c/c++ headers
+#include <cstdint>
+//! dependency headers
+#include <armadillo>
+//! project headers
+#include "transforms/common/cell_grid.hpp"
+
+namespace transforms {
+/**
+ * @class InlierOracle
+ *
+ * @brief membership test "is there a target point within epsilon of this point", precomputed
+ * once per target so that scoring a hypothesis costs one hash probe per source point
+ *
+ * @note the oracle is a sparse occupancy grid dilated by epsilon: only cells (of side
+ * epsilon / `cells_per_radius`) within epsilon of some target point are stored, in a hash table.
+ * A cell that lies entirely within epsilon of a single target point is "inside" and answers
+ * directly.  Every other stored cell is on the boundary of the epsilon-neighborhood and keeps a
+ * short, contiguous list of the target points within epsilon of the cell; queries falling into it
+ * are checked exactly against that list.  Points in cells that are not stored have no target
+ * point within epsilon.
+ * @note queries are const and thread-safe; the build and batched queries are parallelized with
+ * OpenMP when available
+ */
+class InlierOracle {
+ public:
+   /** InlierOracle::InlierOracle()
+    * @brief default constructor; creates an empty oracle (no point is an inlier)
+    *
+    * @param[in]
+    * @return
+    */
+   InlierOracle() { }
+
+   /** InlierOracle::InlierOracle(tgt_pts, epsilon, cells_per_radius)
+    * @brief constructor; builds the oracle
+    *
+    * @param[in] tgt_pts target points (columnar, 3 rows)
+    * @param[in] epsilon inlier distance threshold {> 0}
+    * @param[in] cells_per_radius number of cells per epsilon {>= 1}; larger values shrink the
+    * boundary shell (fewer exact fallbacks) at the cost of more cells
+    * @return
+    */
+   InlierOracle(arma::mat const & tgt_pts, double const & epsilon,
+       size_t const & cells_per_radius = 2) noexcept;
+
+   /** InlierOracle::is_inlier(pt)
+    * @brief check whether a target point lies within epsilon of a point
+    *
+    * @param[in] pt pointer to point (3 contiguous values)
+    * @return true if such a target point exists, false otherwise
+    */
+   bool is_inlier(double const * pt) const noexcept;
+
+   /** InlierOracle::count_inliers(pts)
+    * @brief count points that have a target point within epsilon
+    *
+    * @param[in] pts points (columnar, 3 rows)
+    * @return number of such points
+    */
+   size_t count_inliers(arma::mat const & pts) const noexcept;
+
+   /** InlierOracle::count_inliers(R, t, pts, mask)
+    * @brief count points that have a target point within epsilon after a rigid transformation,
+    * without materializing the transformed points
+    *
+    * @param[in] R rotation applied to `pts`
+    * @param[in] t translation applied to `pts` (after rotation)
+    * @param[in] pts points (columnar, 3 rows)
+    * @param[in][out] mask optional inlier bitmask of ceil(no. of points / 64) words: bit i % 64 of
+    * word i / 64 is set iff point i is an inlier
+    * @return number of such points
+    *
+    * @note points are streamed in blocks of 64 that are transformed into a stack buffer and
+    * probed immediately; nothing is allocated on the heap
+    */
+   size_t count_inliers(arma::mat33 const & R, arma::vec3 const & t, arma::mat const & pts,
+       uint64_t * mask = nullptr) const noexcept;
+
+   /** InlierOracle::epsilon()
+    * @brief get inlier distance threshold
+    *
+    * @param[in]
+    * @return inlier distance threshold
+    */
+   double epsilon() const noexcept { return epsilon_; }
+
+   /** InlierOracle::size()
+    * @brief get number of target points
+    *
+    * @param[in]
+    * @return number of target points
+    */
+   size_t size() const noexcept { return num_targets_; }
+
+   /** InlierOracle::num_inside_cells()
+    * @brief get number of cells that lie entirely within epsilon of the target
+    *
+    * @param[in]
+    * @return number of such cells
+    */
+   size_t num_inside_cells() const noexcept { return num_inside_; }
+
+   /** InlierOracle::num_boundary_cells()
+    * @brief get number of cells that need the exact fallback
+    *
+    * @param[in]
+    * @return number of such cells
+    */
+   size_t num_boundary_cells() const noexcept { return cells_.size() - num_inside_; }
+
+ private:
+   double epsilon_ = 0;  //! inlier distance threshold
+   size_t num_targets_ = 0;  //! number of target points
+   CellGrid grid_;  //! grid over the bounding box of the target, grown by epsilon
+   CellTable cells_;  //! stored cells -> columns of `candidates_` (an empty range if inside)
+   arma::mat candidates_;  //! target points within epsilon of each boundary cell, grouped by cell
+   size_t num_inside_ = 0;  //! number of inside cells
+};
+}  // namespace transforms
@@ -0,0 +1,386 @@
+#pragma once
+//! c/c++ headers
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+//! dependency headers
+#include <armadillo>
+//! project headers
+
+namespace transforms {
+//! alignment (in bytes) of point cloud coordinate arrays: one cache line
+constexpr size_t point_cloud_alignment = 64;
+
+/**
+ * @struct AlignedAllocator
+ * @brief standard allocator whose allocations start on a `point_cloud_alignment` boundary
+ */
+template <typename T>
+struct AlignedAllocator {
+  using value_type = T;
+
+  AlignedAllocator() noexcept { }
+
+  template <typename U>
+  AlignedAllocator(AlignedAllocator<U> const &) noexcept { }  // NOLINT [runtime/explicit]
+
+  T * allocate(size_t const n) {
+    return static_cast<T *>(::operator new(n * sizeof(T),
+          std::align_val_t(point_cloud_alignment)));
+  }
+
+  void deallocate(T * p, size_t const) noexcept {
+    ::operator delete(p, std::align_val_t(point_cloud_alignment));
+  }
+
+  template <typename U>
+  bool operator == (AlignedAllocator<U> const &) const noexcept { return true; }
+
+  template <typename U>
+  bool operator != (AlignedAllocator<U> const &) const noexcept { return false; }
+};
+
+/**
+ * @class PointCloudView
+ * @brief non-owning view of a range of points stored as separate x, y and z arrays; cheap to
+ * copy and pass by value
+ */
+template <typename T>
+class PointCloudView {
+ public:
+   /** PointCloudView::PointCloudView()
+    * @brief default constructor; creates an empty view
+    *
+    * @param[in]
+    * @return
+    */
+   PointCloudView() { }
+
+   /** PointCloudView::PointCloudView(x, y, z, n)
+    * @brief constructor
+    *
+    * @param[in] x pointer to x coordinates (n contiguous values)
+    * @param[in] y pointer to y coordinates (n contiguous values)
+    * @param[in] z pointer to z coordinates (n contiguous values)
+    * @param[in] n number of points
+    * @return
+    */
+   PointCloudView(T const * x, T const * y, T const * z, size_t const & n)
+     : x_(x), y_(y), z_(z), size_(n) { }
+
+   //! coordinate arrays (size() values each)
+   T const * x() const noexcept { return x_; }
+   T const * y() const noexcept { return y_; }
+   T const * z() const noexcept { return z_; }
+
+   /** PointCloudView::size()
+    * @brief get number of points
+    *
+    * @param[in]
+    * @return number of points
+    */
+   size_t size() const noexcept { return size_; }
+
+   /** PointCloudView::empty()
+    * @brief check whether the view has no points
+    *
+    * @param[in]
+    * @return true if there are no points, false otherwise
+    */
+   bool empty() const noexcept { return size_ == 0; }
+
+   /** PointCloudView::subview(begin, count)
+    * @brief view of a contiguous range of the points
+    *
+    * @param[in] begin first point of the range
+    * @param[in] count number of points in the range (clipped to the end of the view)
+    * @return view of the range
+    */
+   PointCloudView subview(size_t const & begin, size_t const & count) const noexcept {
+     size_t const first = std::min(begin, size_);
+     size_t const n = std::min(count, size_ - first);
+     return PointCloudView(x_ + first, y_ + first, z_ + first, n);
+   }
+
+   /** PointCloudView::to_mat(pts)
+    * @brief copy the points into a columnar matrix
+    *
+    * @param[in][out] pts points (3 x size()); reallocated only if its size differs
+    * @return
+    */
+   void to_mat(arma::mat & pts) const noexcept {
+     if (pts.n_rows != 3 || pts.n_cols != size_) {
+       pts.set_size(3, size_);
+     }
+     for (size_t i = 0; i < size_; ++i) {
+       double * p = pts.colptr(i);
+       p[0] = static_cast<double>(x_[i]);
+       p[1] = static_cast<double>(y_[i]);
+       p[2] = static_cast<double>(z_[i]);
+     }
+     return;
+   }
+
+ private:
+   T const * x_ = nullptr;
+   T const * y_ = nullptr;
+   T const * z_ = nullptr;
+   size_t size_ = 0;
+};
+
+/**
+ * @class IndexedPointCloudView
+ * @brief non-owning view of a subset of points, selected by index, of an underlying view (e.g. a
+ * sample or the matched points of a correspondence set)
+ */
+template <typename T>
+class IndexedPointCloudView {
+ public:
+   /** IndexedPointCloudView::IndexedPointCloudView(base, indices, n)
+    * @brief constructor
+    *
+    * @param[in] base underlying points
+    * @param[in] indices pointer to indices into `base` (n contiguous values, each < base.size())
+    * @param[in] n number of indices
+    * @return
+    */
+   IndexedPointCloudView(PointCloudView<T> const & base, size_t const * indices,
+       size_t const & n) : base_(base), indices_(indices), size_(n) { }
+
+   /** IndexedPointCloudView::IndexedPointCloudView(base, indices)
+    * @brief constructor
+    *
+    * @param[in] base underlying points
+    * @param[in] indices indices into `base` (each < base.size()); must outlive the view
+    * @return
+    */
+   IndexedPointCloudView(PointCloudView<T> const & base, std::vector<size_t> const & indices)
+     : base_(base), indices_(indices.data()), size_(indices.size()) { }
+
+   //! coordinates of point i of the view
+   T x(size_t const & i) const noexcept { return base_.x()[indices_[i]]; }
+   T y(size_t const & i) const noexcept { return base_.y()[indices_[i]]; }
+   T z(size_t const & i) const noexcept { return base_.z()[indices_[i]]; }
+
+   /** IndexedPointCloudView::index(i)
+    * @brief get index of a point in the underlying view
+    *
+    * @param[in] i point of this view
+    * @return index into the underlying view
+    */
+   size_t index(size_t const & i) const noexcept { return indices_[i]; }
+
+   /** IndexedPointCloudView::size()
+    * @brief get number of points
+    *
+    * @param[in]
+    * @return number of points
+    */
+   size_t size() const noexcept { return size_; }
+
+   /** IndexedPointCloudView::base()
+    * @brief get underlying view
+    *
+    * @param[in]
+    * @return underlying view
+    */
+   PointCloudView<T> const & base() const noexcept { return base_; }
+
+ private:
+   PointCloudView<T> base_;
+   size_t const * indices_ = nullptr;
+   size_t size_ = 0;
+};
+
+/**
+ * @class BasicPointCloud
+ * @brief point cloud in structure-of-arrays layout: x, y and z coordinates are separate arrays,
+ * each starting on a `point_cloud_alignment` boundary, so that a kernel processing many points
+ * reads each coordinate as contiguous SIMD lanes
+ *
+ * @note the three arrays share one allocation; each is padded to a whole number of alignment
+ * blocks, and the padding is zero
+ * @note `arma::mat` (3 x N, one point per column) is the interchange format of the rest of the
+ * code; see the `arma::mat` constructor and `to_mat`
+ */
+template <typename T>
+class BasicPointCloud {
+ public:
+   using value_type = T;
+
+   /** BasicPointCloud::BasicPointCloud()
+    * @brief default constructor; creates an empty point cloud
+    *
+    * @param[in]
+    * @return
+    */
+   BasicPointCloud() { }
+
+   /** BasicPointCloud::BasicPointCloud(n)
+    * @brief constructor; creates n points at the origin
+    *
+    * @param[in] n number of points
+    * @return
+    */
+   explicit BasicPointCloud(size_t const & n) { resize(n); }
+
+   /** BasicPointCloud::BasicPointCloud(pts)
+    * @brief constructor; copies (and, for float storage, rounds) columnar points
+    *
+    * @param[in] pts points (columnar, 3 rows)
+    * @return
+    */
+   explicit BasicPointCloud(arma::mat const & pts) noexcept {
+     // LCOV_EXCL_START
+     //! input checking
+     if (pts.n_rows != 3) {
+       std::cout << static_cast<std::string>(__func__) <<
+         ": First argument must be a matrix with 3 rows" << std::endl;
+       return;
+     }
+     // LCOV_EXCL_STOP
+     resize(pts.n_cols);
+     for (size_t i = 0; i < size_; ++i) {
+       double const * p = pts.colptr(i);
+       x()[i] = static_cast<T>(p[0]);
+       y()[i] = static_cast<T>(p[1]);
+       z()[i] = static_cast<T>(p[2]);
+     }
+   }
+
+   /** BasicPointCloud::BasicPointCloud(view)
+    * @brief constructor; copies the points of a view
+    *
+    * @param[in] view points to copy
+    * @return
+    */
+   explicit BasicPointCloud(PointCloudView<T> const & view) {
+     resize(view.size());
+     std::copy(view.x(), view.x() + size_, x());
+     std::copy(view.y(), view.y() + size_, y());
+     std::copy(view.z(), view.z() + size_, z());
+   }
+
+   /** BasicPointCloud::BasicPointCloud(view)
+    * @brief constructor; gathers the points of an index view into contiguous storage
+    *
+    * @param[in] view points to copy
+    * @return
+    */
+   explicit BasicPointCloud(IndexedPointCloudView<T> const & view) {
+     resize(view.size());
+     for (size_t i = 0; i < size_; ++i) {
+       x()[i] = view.x(i);
+       y()[i] = view.y(i);
+       z()[i] = view.z(i);
+     }
+   }
+
+   /** BasicPointCloud::resize(n)
+    * @brief change the number of points; existing points are kept, new points are at the origin
+    *
+    * @param[in] n number of points
+    * @return
+    */
+   void resize(size_t const & n) {
+     size_t const stride = padded(n);
+     if (stride != stride_) {
+       std::vector<T, AlignedAllocator<T>> data(3 * stride, T(0));
+       size_t const n_keep = std::min(n, size_);
+       for (size_t r = 0; r < 3; ++r) {
+         std::copy(data_.data() + r * stride_, data_.data() + r * stride_ + n_keep,
+             data.data() + r * stride);
+       }
+       data_.swap(data);
+       stride_ = stride;
+     } else {
+       //! keep the padding (and dropped points) zero
+       for (size_t r = 0; r < 3; ++r) {
+         std::fill(data_.data() + r * stride_ + std::min(n, size_),
+             data_.data() + r * stride_ + stride_, T(0));
+       }
+     }
+     size_ = n;
+     return;
+   }
+
+   //! coordinate arrays (size() values each, aligned to `point_cloud_alignment`)
+   T * x() noexcept { return data_.data(); }
+   T * y() noexcept { return data_.data() + stride_; }
+   T * z() noexcept { return data_.data() + 2 * stride_; }
+   T const * x() const noexcept { return data_.data(); }
+   T const * y() const noexcept { return data_.data() + stride_; }
+   T const * z() const noexcept { return data_.data() + 2 * stride_; }
+
+   /** BasicPointCloud::size()
+    * @brief get number of points
+    *
+    * @param[in]
+    * @return number of points
+    */
+   size_t size() const noexcept { return size_; }
+
+   /** BasicPointCloud::empty()
+    * @brief check whether the point cloud has no points
+    *
+    * @param[in]
+    * @return true if there are no points, false otherwise
+    */
+   bool empty() const noexcept { return size_ == 0; }
+
+   /** BasicPointCloud::view()
+    * @brief non-owning view of all points; invalidated by `resize`
+    *
+    * @param[in]
+    * @return view
+    */
+   PointCloudView<T> view() const noexcept {
+     return PointCloudView<T>(x(), y(), z(), size_);
+   }
+
+   /** BasicPointCloud::to_mat(pts)
+    * @brief copy the points into a columnar matrix
+    *
+    * @param[in][out] pts points (3 x size()); reallocated only if its size differs
+    * @return
+    */
+   void to_mat(arma::mat & pts) const noexcept { view().to_mat(pts); }
+
+   /** BasicPointCloud::to_mat()
+    * @brief copy the points into a columnar matrix
+    *
+    * @param[in]
+    * @return points (3 x size())
+    */
+   arma::mat to_mat() const noexcept {
+     arma::mat pts;
+     to_mat(pts);
+     return pts;
+   }
+
+ private:
+   /** BasicPointCloud::padded(n)
+    * @brief round a number of values up to a whole number of alignment blocks
+    *
+    * @param[in] n number of values
+    * @return padded number of values
+    */
+   static size_t padded(size_t const & n) noexcept {
+     size_t const block = point_cloud_alignment / sizeof(T);
+     return (n + block - 1) / block * block;
+   }
+
+   std::vector<T, AlignedAllocator<T>> data_;  //! x, then y, then z (each `stride_` values)
+   size_t stride_ = 0;  //! padded size of each coordinate array
+   size_t size_ = 0;  //! number of points
+};
+
+//! double-precision point cloud
+using PointCloud = BasicPointCloud<double>;
+
+//! single-precision point cloud (half the memory traffic, twice the SIMD lanes)
+using PointCloudF = BasicPointCloud<float>;
+}  // namespace transforms
@@ -0,0 +1,144 @@
+#pragma once
+//! c/c++ headers
+#include <cstdint>
+#include <vector>
+//! dependency headers
+#include <armadillo>
+//! project headers
+#include "transforms/common/cell_grid.hpp"
+
+namespace transforms {
+/**
+ * @class VoxelHash
+ *
+ * @brief spatial index for fixed-radius queries: is there a point within the radius of a query,
+ * and which is the nearest one
+ *
+ * @note points are bucketed into cubic cells whose side is (at least) the query radius, so every
+ * point within the radius of a query lies in the 3x3x3 block of cells around the query's cell.
+ * Points are stored sorted by cell (contiguous, columnar) and occupied cells are kept in an
+ * open-addressing hash table of (key, begin, end) entries, so a query costs 27 expected O(1)
+ * lookups plus a scan of the points in those cells.
+ * @note queries are const and thread-safe; the build and batched queries are parallelized with
+ * OpenMP when available
+ */
+class VoxelHash {
+ public:
+   /** VoxelHash::VoxelHash()
+    * @brief default constructor; creates an empty index (all queries fail)
+    *
+    * @param[in]
+    * @return
+    */
+   VoxelHash() { }
+
+   /** VoxelHash::VoxelHash(pts, radius)
+    * @brief constructor; builds the index
+    *
+    * @param[in] pts points to index (columnar, 3 rows)
+    * @param[in] radius query radius {> 0}
+    * @return
+    *
+    * @note the cell size is increased beyond `radius` if needed to keep cell coordinates within
+    * 21 bits per axis; queries remain exact
+    */
+   VoxelHash(arma::mat const & pts, double const & radius) noexcept;
+
+   /** VoxelHash::nearest(query, index, distance)
+    * @brief find the nearest indexed point within the radius of a query point
+    *
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in][out] index column of nearest point in the `pts` used to build the index
+    * @param[in][out] distance distance to nearest point
+    * @return true if a point was found within the radius, false otherwise (outputs untouched)
+    */
+   bool nearest(double const * query, size_t & index, double & distance) const noexcept;
+
+   /** VoxelHash::any_within(query, radius)
+    * @brief check whether any indexed point lies within `radius` of a query point
+    *
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in] radius query radius {<= `radius()`}
+    * @return true if such a point exists, false otherwise
+    */
+   bool any_within(double const * query, double const & radius) const noexcept;
+
+   /** VoxelHash::search(queries, neighbors, distances)
+    * @brief batched nearest-neighbor search within the radius, with the same output layout as
+    * `KDTreeSearcher::Search` for k = 1
+    *
+    * @param[in] queries query points (columnar, 3 rows)
+    * @param[in][out] neighbors nearest indexed point for each query (1 x no. of queries); `size()`
+    * if there is none within the radius
+    * @param[in][out] distances distance to nearest indexed point (1 x no. of queries); infinity if
+    * there is none within the radius
+    * @return number of queries with a point within the radius
+    */
+   size_t search(arma::mat const & queries, arma::Mat<size_t> & neighbors,
+       arma::mat & distances) const noexcept;
+
+   /** VoxelHash::count_within(queries, radius)
+    * @brief count query points that have an indexed point within `radius`
+    *
+    * @param[in] queries query points (columnar, 3 rows)
+    * @param[in] radius query radius {<= `radius()`}
+    * @return number of such query points
+    */
+   size_t count_within(arma::mat const & queries, double const & radius) const noexcept;
+
+   /** VoxelHash::within(query, radius, indices)
+    * @brief find all indexed points within `radius` of a query point
+    *
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in] radius query radius {<= `radius()`}
+    * @param[in][out] indices columns of such points in the `pts` used to build the index
+    * (appended, in no particular order)
+    * @return
+    */
+   void within(double const * query, double const & radius,
+       std::vector<size_t> & indices) const noexcept;
+
+   /** VoxelHash::radius()
+    * @brief get query radius the index was built for
+    *
+    * @param[in]
+    * @return query radius
+    */
+   double radius() const noexcept { return radius_; }
+
+   /** VoxelHash::size()
+    * @brief get number of indexed points
+    *
+    * @param[in]
+    * @return number of indexed points
+    */
+   size_t size() const noexcept { return index_.size(); }
+
+   /** VoxelHash::num_cells()
+    * @brief get number of occupied cells
+    *
+    * @param[in]
+    * @return number of occupied cells
+    */
+   size_t num_cells() const noexcept { return cells_.size(); }
+
+ private:
+   /** VoxelHash::visit(query, radius, f)
+    * @brief call `f(column, squared distance)` for each indexed point within `radius` of the
+    * query until `f` returns false
+    *
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in] radius query radius {<= `radius()`}
+    * @param[in] f visitor
+    * @return
+    */
+   template <typename F>
+   void visit(double const * query, double const & radius, F && f) const noexcept;
+
+   double radius_ = 0;  //! query radius the index was built for
+   CellGrid grid_;  //! grid over the bounding box of indexed points (cell size >= radius_)
+   arma::mat points_;  //! indexed points, sorted by cell
+   std::vector<uint32_t> index_;  //! original column of each point in `points_`
+   CellTable cells_;  //! occupied cells -> columns of `points_`
+};
+}  // namespace transforms
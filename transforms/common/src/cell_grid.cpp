@@ -0,0 +1,185 @@
+//! c/c++ headers
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <utility>
+//! dependency headers
+//! project headers
+#include "transforms/common/cell_grid.hpp"
+
+namespace {
+//! marks an unused hash table slot (no packed key has all 64 bits set)
+constexpr uint64_t empty_key = std::numeric_limits<uint64_t>::max();
+
+/**
+ * @brief multiplicative (Fibonacci) hash of a packed key
+ *
+ * @param[in] key packed cell coordinates
+ * @param[in] shift 64 - log2(no. of slots)
+ * @return slot
+ */
+inline size_t slot_of(uint64_t const & key, int const & shift) noexcept {
+  return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+}
+}  // namespace
+
+/** CellGrid::fit(pts, min_cell_size, margin)
+ * @brief fit the grid to the bounding box of a set of points
+ *
+ * @param[in] pts points (columnar, 3 rows, at least one column)
+ * @param[in] min_cell_size requested cell size; increased only if the box would need more than
+ * `max_dim` cells along an axis
+ * @param[in] margin distance by which the bounding box is grown on every side
+ * @return
+ */
+void transforms::CellGrid::fit(arma::mat const & pts, double const & min_cell_size,
+    double const & margin) noexcept {
+  origin = arma::min(pts, 1) - margin;
+  arma::vec3 const extent = arma::max(pts, 1) + margin - origin;
+  //! every point of the box, including its upper faces, lies in a cell with coordinates below
+  //! `max_dim`
+  cell_size = std::max(min_cell_size, extent.max() / static_cast<double>(max_dim - 1));
+  for (size_t r = 0; r < 3; ++r) {
+    dims[r] = static_cast<int64_t>(std::floor(extent(r) / cell_size)) + 1;
+  }
+  return;
+}
+
+/** CellGrid::cell_of(p, c)
+ * @brief cell coordinates of a point (not clamped to the grid)
+ *
+ * @param[in] p pointer to point (3 contiguous values)
+ * @param[in][out] c cell coordinates
+ * @return false if the point is more than one cell outside the grid (or not finite), true
+ * otherwise
+ */
+bool transforms::CellGrid::cell_of(double const * p, int64_t c[3]) const noexcept {
+  for (size_t r = 0; r < 3; ++r) {
+    double const x = std::floor((p[r] - origin(r)) / cell_size);
+    if (!(x >= -1 && x <= static_cast<double>(dims[r]))) {
+      return false;
+    }
+    c[r] = static_cast<int64_t>(x);
+  }
+  return true;
+}
+
+/** CellTable::build(cells)
+ * @brief (re)build the table
+ *
+ * @param[in] cells entries to insert (keys must be unique)
+ * @return
+ */
+void transforms::CellTable::build(std::vector<Cell> const & cells) noexcept {
+  size_t capacity = 2;
+  shift_ = 63;
+  while (capacity < 2 * cells.size()) {
+    capacity *= 2;
+    --shift_;
+  }
+  slots_.assign(capacity, Cell{empty_key, 0, 0});
+  for (auto const & cell : cells) {
+    size_t slot = slot_of(cell.key, shift_);
+    while (slots_[slot].key != empty_key) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    slots_[slot] = cell;
+  }
+  size_ = cells.size();
+  return;
+}
+
+/** CellTable::find(key)
+ * @brief look up an entry
+ *
+ * @param[in] key packed cell coordinates
+ * @return pointer to entry, or nullptr if there is none
+ */
+transforms::CellTable::Cell const * transforms::CellTable::find(
+    uint64_t const & key) const noexcept {
+  if (size_ == 0) {
+    return nullptr;
+  }
+  size_t const mask = slots_.size() - 1;
+  size_t slot = slot_of(key, shift_);
+  while (slots_[slot].key != empty_key) {
+    if (slots_[slot].key == key) {
+      return &slots_[slot];
+    }
+    slot = (slot + 1) & mask;
+  }
+  return nullptr;
+}
+
+/**
+ * @brief sort (key, column) pairs; chunks are sorted in parallel, then merged pairwise
+ *
+ * @param[in][out] items pairs to sort
+ * @return
+ */
+void transforms::parallel_sort(std::vector<std::pair<uint64_t, uint32_t>> & items) noexcept {
+  int64_t const n = static_cast<int64_t>(items.size());
+  int64_t const chunk = std::max(static_cast<int64_t>(1) << 14, n / 64 + 1);
+  int64_t const n_chunks = (n + chunk - 1) / chunk;
+  #pragma omp parallel for schedule(static)
+  for (int64_t c = 0; c < n_chunks; ++c) {
+    std::sort(items.begin() + c * chunk, items.begin() + std::min(n, (c + 1) * chunk));
+  }
+  for (int64_t width = chunk; width < n; width *= 2) {
+    int64_t const n_pairs = (n + 2 * width - 1) / (2 * width);
+    #pragma omp parallel for schedule(static)
+    for (int64_t p = 0; p < n_pairs; ++p) {
+      int64_t const first = p * 2 * width;
+      int64_t const middle = std::min(n, first + width);
+      int64_t const last = std::min(n, first + 2 * width);
+      std::inplace_merge(items.begin() + first, items.begin() + middle, items.begin() + last);
+    }
+  }
+  return;
+}
+
+/**
+ * @brief order of points along a Morton (z-order) curve over their bounding box, so that points
+ * close in space are mostly close in the order
+ *
+ * @param[in] pts points (columnar, 3 rows)
+ * @param[in][out] order columns of `pts` in Morton order (points in the same finest cell keep
+ * their relative order)
+ * @return
+ */
+void transforms::morton_order(arma::mat const & pts, std::vector<size_t> & order) noexcept {
+  size_t const n = pts.n_cols;
+  order.resize(n);
+  // LCOV_EXCL_START
+  //! input checking
+  if (pts.n_rows != 3 || n > static_cast<size_t>(std::numeric_limits<uint32_t>::max())) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": First argument must be a matrix with 3 rows and fewer than 2^32 columns" << std::endl;
+    std::iota(order.begin(), order.end(), 0);
+    return;
+  }
+  // LCOV_EXCL_STOP
+  if (n == 0) {
+    return;
+  }
+
+  //! finest grid the keys can resolve: `max_dim` cells along the longest side of the box
+  CellGrid grid;
+  arma::vec3 const extent = arma::max(pts, 1) - arma::min(pts, 1);
+  grid.fit(pts, (extent.max() > 0) ? 0 : 1, 0);
+  std::vector<std::pair<uint64_t, uint32_t>> keyed(n);
+  #pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+    int64_t c[3] = {0, 0, 0};
+    grid.cell_of(pts.colptr(i), c);
+    keyed[i] = std::make_pair(CellGrid::morton(c[0], c[1], c[2]), static_cast<uint32_t>(i));
+  }
+  parallel_sort(keyed);
+  for (size_t i = 0; i < n; ++i) {
+    order[i] = keyed[i].second;
+  }
+  return;
+}
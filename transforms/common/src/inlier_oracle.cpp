@@ -0,0 +1,323 @@
+//! c/c++ headers
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+//! dependency headers
+//! project headers
+#include "transforms/common/inlier_oracle.hpp"
+#include "transforms/common/voxel_hash.hpp"
+
+/** InlierOracle::InlierOracle(tgt_pts, epsilon, cells_per_radius)
+ * @brief constructor; builds the oracle
+ *
+ * @param[in] tgt_pts target points (columnar, 3 rows)
+ * @param[in] epsilon inlier distance threshold {> 0}
+ * @param[in] cells_per_radius number of cells per epsilon {>= 1}; larger values shrink the
+ * boundary shell (fewer exact fallbacks) at the cost of more cells
+ * @return
+ */
+transforms::InlierOracle::InlierOracle(arma::mat const & tgt_pts, double const & epsilon,
+    size_t const & cells_per_radius) noexcept : epsilon_(epsilon) {
+  // LCOV_EXCL_START
+  //! input checking
+  if (tgt_pts.n_rows != 3) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": First argument must be a matrix with 3 rows" << std::endl;
+    return;
+  } else if (!(epsilon > 0)) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Second argument must be a positive scalar" << std::endl;
+    return;
+  } else if (cells_per_radius == 0) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Third argument must be a positive integer" << std::endl;
+    return;
+  }
+  // LCOV_EXCL_STOP
+  num_targets_ = tgt_pts.n_cols;
+  if (tgt_pts.n_cols == 0) {
+    return;
+  }
+
+  //! every point within epsilon of the target lies inside the grid
+  grid_.fit(tgt_pts, epsilon_ / static_cast<double>(cells_per_radius), epsilon_);
+  double const h = grid_.cell_size;
+  //! cells are padded so that points rounded into a neighboring cell are covered
+  double const pad = 1e-6 * h;
+  double const half_diag = 0.5 * std::sqrt(3.) * h + pad;
+  //! target points within epsilon of a cell are within epsilon + half_diag of its center
+  VoxelHash const targets(tgt_pts, epsilon_ + half_diag);
+
+  //! occupied target cells
+  int64_t const n = static_cast<int64_t>(tgt_pts.n_cols);
+  std::vector<std::pair<uint64_t, uint32_t>> occupied(n);
+  #pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < n; ++i) {
+    int64_t c[3];
+    grid_.cell_of(tgt_pts.colptr(i), c);
+    occupied[i] = std::make_pair(CellGrid::pack(c[0], c[1], c[2]), static_cast<uint32_t>(0));
+  }
+  parallel_sort(occupied);
+  occupied.erase(std::unique(occupied.begin(), occupied.end()), occupied.end());
+
+  //! dilation stencil: offsets whose cell center can be within epsilon + half_diag of a point in
+  //! the occupied cell
+  int64_t const k = static_cast<int64_t>(std::ceil((epsilon_ + half_diag) / h + 0.5));
+  std::vector<int64_t> stencil;
+  for (int64_t dx = -k; dx <= k; ++dx) {
+    for (int64_t dy = -k; dy <= k; ++dy) {
+      for (int64_t dz = -k; dz <= k; ++dz) {
+        double gap_sq = 0;
+        for (int64_t const d : {dx, dy, dz}) {
+          double const gap = std::max(std::abs(static_cast<double>(d)) - 0.5, 0.) * h;
+          gap_sq += gap * gap;
+        }
+        if (gap_sq <= (epsilon_ + half_diag) * (epsilon_ + half_diag)) {
+          stencil.insert(stencil.end(), {dx, dy, dz});
+        }
+      }
+    }
+  }
+
+  //! candidate cells: the occupied cells dilated by the stencil, deduplicated.  Occupied cells are
+  //! dilated in chunks of consecutive cells in Morton order, and each chunk is deduplicated on its
+  //! own: a chunk is compact in space, so chunks only overlap at their borders and the memory used
+  //! stays proportional to the number of dilated cells (not to occupied cells x stencil size)
+  int64_t const n_occupied = static_cast<int64_t>(occupied.size());
+  int64_t const n_stencil = static_cast<int64_t>(stencil.size() / 3);
+  std::vector<std::pair<uint64_t, uint32_t>> by_morton(n_occupied);
+  #pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < n_occupied; ++i) {
+    int64_t c[3];
+    CellGrid::unpack(occupied[i].first, c);
+    by_morton[i] = std::make_pair(CellGrid::morton(c[0], c[1], c[2]), static_cast<uint32_t>(i));
+  }
+  parallel_sort(by_morton);
+  //! about 2^20 dilated cells (before deduplication) per chunk
+  int64_t const chunk = std::max(static_cast<int64_t>(1),
+      (static_cast<int64_t>(1) << 20) / std::max(n_stencil, static_cast<int64_t>(1)));
+  int64_t const n_chunks = (n_occupied + chunk - 1) / chunk;
+  std::vector<std::vector<uint64_t>> chunk_cells(n_chunks);
+  #pragma omp parallel
+  {
+    std::vector<uint64_t> keys;
+    #pragma omp for schedule(dynamic, 1)
+    for (int64_t b = 0; b < n_chunks; ++b) {
+      keys.clear();
+      int64_t const end = std::min(n_occupied, (b + 1) * chunk);
+      for (int64_t i = b * chunk; i < end; ++i) {
+        int64_t c[3];
+        CellGrid::unpack(occupied[by_morton[i].second].first, c);
+        for (int64_t s = 0; s < n_stencil; ++s) {
+          int64_t const d[3] = {c[0] + stencil[3 * s], c[1] + stencil[3 * s + 1],
+            c[2] + stencil[3 * s + 2]};
+          if (grid_.contains(d)) {
+            keys.push_back(CellGrid::pack(d[0], d[1], d[2]));
+          }
+        }
+      }
+      std::sort(keys.begin(), keys.end());
+      chunk_cells[b].assign(keys.begin(), std::unique(keys.begin(), keys.end()));
+    }
+  }
+  size_t n_chunk_cells = 0;
+  for (auto const & cells : chunk_cells) {
+    n_chunk_cells += cells.size();
+  }
+  std::vector<std::pair<uint64_t, uint32_t>> candidates;
+  candidates.reserve(n_chunk_cells);
+  for (auto & cells : chunk_cells) {
+    for (auto const & key : cells) {
+      candidates.emplace_back(key, static_cast<uint32_t>(0));
+    }
+    std::vector<uint64_t>().swap(cells);
+  }
+  parallel_sort(candidates);
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  //! classify a candidate cell: returns true if the cell lies within epsilon of a single target
+  //! point (inside); otherwise `near` holds the target points within epsilon of the cell (empty if
+  //! the cell is outside the epsilon-neighborhood)
+  double const eps_sq = epsilon_ * epsilon_;
+  auto classify = [&](uint64_t const & key, std::vector<size_t> & near) {
+    int64_t c[3];
+    CellGrid::unpack(key, c);
+    double lo[3], hi[3], center[3];
+    for (size_t r = 0; r < 3; ++r) {
+      lo[r] = grid_.origin(r) + static_cast<double>(c[r]) * h - pad;
+      hi[r] = lo[r] + h + 2 * pad;
+      center[r] = 0.5 * (lo[r] + hi[r]);
+    }
+    near.clear();
+    targets.within(center, epsilon_ + half_diag, near);
+    size_t n_near = 0;
+    for (auto const & j : near) {
+      double const * t = tgt_pts.colptr(j);
+      double gap_sq = 0, far_sq = 0;
+      for (size_t r = 0; r < 3; ++r) {
+        double const gap = std::max({lo[r] - t[r], t[r] - hi[r], 0.});
+        double const far = std::max(t[r] - lo[r], hi[r] - t[r]);
+        gap_sq += gap * gap;
+        far_sq += far * far;
+      }
+      if (far_sq <= eps_sq) {
+        near.clear();
+        return true;
+      } else if (gap_sq <= eps_sq) {
+        near[n_near++] = j;
+      }
+    }
+    near.resize(n_near);
+    return false;
+  };
+
+  //! first pass: classify; -1 marks inside cells, otherwise the number of target points near the
+  //! cell (0 if outside)
+  int64_t const n_candidates = static_cast<int64_t>(candidates.size());
+  std::vector<int64_t> n_near(n_candidates);
+  #pragma omp parallel
+  {
+    std::vector<size_t> near;
+    #pragma omp for schedule(dynamic, 256)
+    for (int64_t i = 0; i < n_candidates; ++i) {
+      n_near[i] = classify(candidates[i].first, near) ? -1 : static_cast<int64_t>(near.size());
+    }
+  }
+
+  //! table entries; boundary cells get consecutive ranges of `candidates_`
+  std::vector<CellTable::Cell> cells;
+  std::vector<int64_t> offsets(n_candidates, 0);
+  uint32_t n_stored = 0;
+  for (int64_t i = 0; i < n_candidates; ++i) {
+    if (n_near[i] < 0) {
+      cells.push_back(CellTable::Cell{candidates[i].first, n_stored, n_stored});
+      ++num_inside_;
+    } else if (n_near[i] > 0) {
+      offsets[i] = n_stored;
+      cells.push_back(CellTable::Cell{candidates[i].first, n_stored,
+          static_cast<uint32_t>(n_stored + n_near[i])});
+      n_stored += static_cast<uint32_t>(n_near[i]);
+    }
+  }
+  cells_.build(cells);
+
+  //! second pass: gather the target points near each boundary cell
+  candidates_.set_size(3, n_stored);
+  #pragma omp parallel
+  {
+    std::vector<size_t> near;
+    #pragma omp for schedule(dynamic, 256)
+    for (int64_t i = 0; i < n_candidates; ++i) {
+      if (n_near[i] > 0) {
+        classify(candidates[i].first, near);
+        for (size_t j = 0; j < near.size(); ++j) {
+          candidates_.col(offsets[i] + j) = tgt_pts.col(near[j]);
+        }
+      }
+    }
+  }
+}
+
+/** InlierOracle::is_inlier(pt)
+ * @brief check whether a target point lies within epsilon of a point
+ *
+ * @param[in] pt pointer to point (3 contiguous values)
+ * @return true if such a target point exists, false otherwise
+ */
+bool transforms::InlierOracle::is_inlier(double const * pt) const noexcept {
+  int64_t c[3];
+  if (cells_.size() == 0 || !grid_.cell_of(pt, c) || !grid_.contains(c)) {
+    return false;
+  }
+  CellTable::Cell const * cell = cells_.find(CellGrid::pack(c[0], c[1], c[2]));
+  if (cell == nullptr) {
+    return false;
+  } else if (cell->begin == cell->end) {
+    return true;
+  }
+  //! boundary cell: exact check against the target points near the cell
+  double const eps_sq = epsilon_ * epsilon_;
+  for (uint32_t k = cell->begin; k < cell->end; ++k) {
+    double const * t = candidates_.colptr(k);
+    double const dx = t[0] - pt[0];
+    double const dy = t[1] - pt[1];
+    double const dz = t[2] - pt[2];
+    if (dx * dx + dy * dy + dz * dz <= eps_sq) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** InlierOracle::count_inliers(pts)
+ * @brief count points that have a target point within epsilon
+ *
+ * @param[in] pts points (columnar, 3 rows)
+ * @return number of such points
+ */
+size_t transforms::InlierOracle::count_inliers(arma::mat const & pts) const noexcept {
+  int64_t const n = static_cast<int64_t>(pts.n_cols);
+  int64_t count = 0;
+  #pragma omp parallel for schedule(static) reduction(+:count)
+  for (int64_t i = 0; i < n; ++i) {
+    count += is_inlier(pts.colptr(i));
+  }
+  return static_cast<size_t>(count);
+}
+
+/** InlierOracle::count_inliers(R, t, pts, mask)
+ * @brief count points that have a target point within epsilon after a rigid transformation,
+ * without materializing the transformed points
+ *
+ * @param[in] R rotation applied to `pts`
+ * @param[in] t translation applied to `pts` (after rotation)
+ * @param[in] pts points (columnar, 3 rows)
+ * @param[in][out] mask optional inlier bitmask of ceil(no. of points / 64) words: bit i % 64 of
+ * word i / 64 is set iff point i is an inlier
+ * @return number of such points
+ *
+ * @note points are streamed in blocks of 64 that are transformed into a stack buffer and probed
+ * immediately; nothing is allocated on the heap
+ */
+size_t transforms::InlierOracle::count_inliers(arma::mat33 const & R, arma::vec3 const & t,
+    arma::mat const & pts, uint64_t * mask) const noexcept {
+  constexpr int64_t block = 64;
+  //! transformation in scalars, so that it stays in registers
+  double const r00 = R(0, 0), r01 = R(0, 1), r02 = R(0, 2);
+  double const r10 = R(1, 0), r11 = R(1, 1), r12 = R(1, 2);
+  double const r20 = R(2, 0), r21 = R(2, 1), r22 = R(2, 2);
+  double const t0 = t(0), t1 = t(1), t2 = t(2);
+
+  int64_t const n = static_cast<int64_t>(pts.n_cols);
+  int64_t const n_blocks = (n + block - 1) / block;
+  int64_t count = 0;
+  #pragma omp parallel for schedule(static) reduction(+:count)
+  for (int64_t b = 0; b < n_blocks; ++b) {
+    int64_t const m = std::min(block, n - b * block);
+    double const * p = pts.colptr(b * block);
+    double xform[3 * block];
+    #pragma omp simd
+    for (int64_t j = 0; j < m; ++j) {
+      double const x = p[3 * j];
+      double const y = p[3 * j + 1];
+      double const z = p[3 * j + 2];
+      xform[3 * j] = r00 * x + r01 * y + r02 * z + t0;
+      xform[3 * j + 1] = r10 * x + r11 * y + r12 * z + t1;
+      xform[3 * j + 2] = r20 * x + r21 * y + r22 * z + t2;
+    }
+    uint64_t word = 0;
+    for (int64_t j = 0; j < m; ++j) {
+      if (is_inlier(xform + 3 * j)) {
+        word |= static_cast<uint64_t>(1) << j;
+        ++count;
+      }
+    }
+    if (mask != nullptr) {
+      mask[b] = word;
+    }
+  }
+  return static_cast<size_t>(count);
+}
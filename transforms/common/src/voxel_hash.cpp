@@ -0,0 +1,228 @@
+//! c/c++ headers
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+//! dependency headers
+//! project headers
+#include "transforms/common/voxel_hash.hpp"
+
+/** VoxelHash::VoxelHash(pts, radius)
+ * @brief constructor; builds the index
+ *
+ * @param[in] pts points to index (columnar, 3 rows)
+ * @param[in] radius query radius {> 0}
+ * @return
+ */
+transforms::VoxelHash::VoxelHash(arma::mat const & pts, double const & radius) noexcept
+  : radius_(radius) {
+  // LCOV_EXCL_START
+  //! input checking
+  if (pts.n_rows != 3) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": First argument must be a matrix with 3 rows" << std::endl;
+    return;
+  } else if (!(radius > 0)) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Radius must be a positive scalar" << std::endl;
+    return;
+  } else if (pts.n_cols >= std::numeric_limits<uint32_t>::max()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Too many points to index" << std::endl;
+    return;
+  }
+  // LCOV_EXCL_STOP
+  if (pts.n_cols == 0) {
+    return;
+  }
+
+  //! grid over the bounding box; cells grow beyond the radius only for very large extents
+  grid_.fit(pts, radius_, 0);
+
+  //! cell key of every point
+  int64_t const n = static_cast<int64_t>(pts.n_cols);
+  std::vector<std::pair<uint64_t, uint32_t>> keyed(n);
+  #pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < n; ++i) {
+    int64_t c[3];
+    grid_.cell_of(pts.colptr(i), c);
+    keyed[i] = std::make_pair(CellGrid::pack(c[0], c[1], c[2]), static_cast<uint32_t>(i));
+  }
+
+  //! sort by cell so that each cell's points are contiguous, then gather
+  parallel_sort(keyed);
+  points_.set_size(3, n);
+  index_.resize(n);
+  #pragma omp parallel for schedule(static)
+  for (int64_t k = 0; k < n; ++k) {
+    points_.col(k) = pts.col(keyed[k].second);
+    index_[k] = keyed[k].second;
+  }
+
+  //! one table entry per run of equal keys
+  std::vector<CellTable::Cell> cells;
+  uint32_t begin = 0;
+  for (int64_t k = 1; k <= n; ++k) {
+    if (k == n || keyed[k].first != keyed[begin].first) {
+      cells.push_back(CellTable::Cell{keyed[begin].first, begin, static_cast<uint32_t>(k)});
+      begin = static_cast<uint32_t>(k);
+    }
+  }
+  cells_.build(cells);
+}
+
+/** VoxelHash::visit(query, radius, f)
+ * @brief call `f(column, squared distance)` for each indexed point within `radius` of the query
+ * until `f` returns false
+ *
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in] radius query radius {<= `radius()`}
+ * @param[in] f visitor
+ * @return
+ */
+template <typename F>
+void transforms::VoxelHash::visit(double const * query, double const & radius,
+    F && f) const noexcept {
+  //! cell of the query; queries more than one cell outside the grid cannot have neighbors
+  int64_t c[3];
+  if (cells_.size() == 0 || !grid_.cell_of(query, c)) {
+    return;
+  }
+
+  double const radius_sq = radius * radius;
+  int64_t const * dims = grid_.dims;
+  for (int64_t ix = std::max<int64_t>(c[0] - 1, 0); ix <= std::min(c[0] + 1, dims[0] - 1); ++ix) {
+    for (int64_t iy = std::max<int64_t>(c[1] - 1, 0); iy <= std::min(c[1] + 1, dims[1] - 1);
+        ++iy) {
+      for (int64_t iz = std::max<int64_t>(c[2] - 1, 0); iz <= std::min(c[2] + 1, dims[2] - 1);
+          ++iz) {
+        CellTable::Cell const * cell = cells_.find(CellGrid::pack(ix, iy, iz));
+        if (cell == nullptr) {
+          continue;
+        }
+        for (uint32_t k = cell->begin; k < cell->end; ++k) {
+          double const * p = points_.colptr(k);
+          double const dx = p[0] - query[0];
+          double const dy = p[1] - query[1];
+          double const dz = p[2] - query[2];
+          double const d_sq = dx * dx + dy * dy + dz * dz;
+          if (d_sq <= radius_sq && !f(k, d_sq)) {
+            return;
+          }
+        }
+      }
+    }
+  }
+  return;
+}
+
+/** VoxelHash::nearest(query, index, distance)
+ * @brief find the nearest indexed point within the radius of a query point
+ *
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in][out] index column of nearest point in the `pts` used to build the index
+ * @param[in][out] distance distance to nearest point
+ * @return true if a point was found within the radius, false otherwise (outputs untouched)
+ */
+bool transforms::VoxelHash::nearest(double const * query, size_t & index,
+    double & distance) const noexcept {
+  double best_sq = std::numeric_limits<double>::infinity();
+  uint32_t best = 0;
+  visit(query, radius_, [&best_sq, &best](uint32_t const & k, double const & d_sq) {
+    if (d_sq < best_sq) {
+      best_sq = d_sq;
+      best = k;
+    }
+    return true;
+  });
+  if (best_sq == std::numeric_limits<double>::infinity()) {
+    return false;
+  }
+  index = index_[best];
+  distance = std::sqrt(best_sq);
+  return true;
+}
+
+/** VoxelHash::any_within(query, radius)
+ * @brief check whether any indexed point lies within `radius` of a query point
+ *
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in] radius query radius {<= `radius()`}
+ * @return true if such a point exists, false otherwise
+ */
+bool transforms::VoxelHash::any_within(double const * query,
+    double const & radius) const noexcept {
+  bool found = false;
+  visit(query, std::min(radius, radius_), [&found](uint32_t const &, double const &) {
+    found = true;
+    return false;
+  });
+  return found;
+}
+
+/** VoxelHash::search(queries, neighbors, distances)
+ * @brief batched nearest-neighbor search within the radius, with the same output layout as
+ * `KDTreeSearcher::Search` for k = 1
+ *
+ * @param[in] queries query points (columnar, 3 rows)
+ * @param[in][out] neighbors nearest indexed point for each query (1 x no. of queries); `size()`
+ * if there is none within the radius
+ * @param[in][out] distances distance to nearest indexed point (1 x no. of queries); infinity if
+ * there is none within the radius
+ * @return number of queries with a point within the radius
+ */
+size_t transforms::VoxelHash::search(arma::mat const & queries, arma::Mat<size_t> & neighbors,
+    arma::mat & distances) const noexcept {
+  neighbors.set_size(1, queries.n_cols);
+  distances.set_size(1, queries.n_cols);
+  int64_t const n = static_cast<int64_t>(queries.n_cols);
+  int64_t found = 0;
+  #pragma omp parallel for schedule(static) reduction(+:found)
+  for (int64_t i = 0; i < n; ++i) {
+    if (nearest(queries.colptr(i), neighbors(0, i), distances(0, i))) {
+      ++found;
+    } else {
+      neighbors(0, i) = size();
+      distances(0, i) = std::numeric_limits<double>::infinity();
+    }
+  }
+  return static_cast<size_t>(found);
+}
+
+/** VoxelHash::count_within(queries, radius)
+ * @brief count query points that have an indexed point within `radius`
+ *
+ * @param[in] queries query points (columnar, 3 rows)
+ * @param[in] radius query radius {<= `radius()`}
+ * @return number of such query points
+ */
+size_t transforms::VoxelHash::count_within(arma::mat const & queries,
+    double const & radius) const noexcept {
+  int64_t const n = static_cast<int64_t>(queries.n_cols);
+  int64_t count = 0;
+  #pragma omp parallel for schedule(static) reduction(+:count)
+  for (int64_t i = 0; i < n; ++i) {
+    count += any_within(queries.colptr(i), radius);
+  }
+  return static_cast<size_t>(count);
+}
+
+/** VoxelHash::within(query, radius, indices)
+ * @brief find all indexed points within `radius` of a query point
+ *
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in] radius query radius {<= `radius()`}
+ * @param[in][out] indices columns of such points in the `pts` used to build the index
+ * (appended, in no particular order)
+ * @return
+ */
+void transforms::VoxelHash::within(double const * query, double const & radius,
+    std::vector<size_t> & indices) const noexcept {
+  visit(query, std::min(radius, radius_), [this, &indices](uint32_t const & k, double const &) {
+    indices.push_back(index_[k]);
+    return true;
+  });
+  return;
+}
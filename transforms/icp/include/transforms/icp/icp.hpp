@@ -1,9 +1,12 @@
 #pragma once
 //! c/c++ headers
+#include <vector>
 //! dependency headers
 #include <mlpack/core.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 //! project headers
+#include "transforms/common/voxel_hash.hpp"
+#include "transforms/icp/parallel_searcher.hpp"
 
 namespace transforms {
 
@@ -14,6 +17,331 @@ using KDTreeSearcher = mlpack::neighbor::NeighborSearch<
   mlpack::tree::KDTree
 >;
 
+/**
+ * @enum class icp_method_e
+ * @brief error metric minimized at each iteration of icp
+ *
+ * point_to_point: distance between matched points (closed-form, see best_fit_transform)
+ * point_to_plane: distance from source points to tangent planes at matched target points
+ * (linearized, solved with 6x6 normal equations; requires target normals)
+ * gicp: generalized icp (plane-to-plane); Mahalanobis distance between matched points under
+ * per-point source and target covariances, minimized by Gauss-Newton steps on SE(3)
+ */
+enum class icp_method_e {
+  point_to_point = 0,
+  point_to_plane = 1,
+  gicp = 2
+};
+
+/**
+ * @struct ICPConfig
+ * @brief configurable parameters for icp
+ *
+ * @var ICPConfig::max_its
+ * maximum number of iterations
+ * @var ICPConfig::tolerance
+ * criteria for convergence, in terms of mean error between iterations
+ * @var ICPConfig::reject_ratio
+ * ratio of worst-matches to reject in fit
+ * @var ICPConfig::method
+ * error metric; see `icp_method_e`
+ * @var ICPConfig::normal_neighbors
+ * number of nearest neighbors used to estimate each normal (point_to_plane) or covariance (gicp)
+ * @var ICPConfig::covariance_epsilon
+ * variance along the normal of each (unit in-plane variance) gicp covariance
+ * @var ICPConfig::anderson_depth
+ * number of previous iterates used for Anderson acceleration of the transformation updates
+ * (0 disables acceleration)
+ * @var ICPConfig::coarse_fraction
+ * fraction of source points used in the first (coarsest) level of the coarse-to-fine schedule
+ * {\in (0, 1]; 1 disables the schedule}
+ * @var ICPConfig::coarse_growth
+ * factor by which the number of active source points grows between levels {> 1}
+ * @var ICPConfig::coarse_tolerance
+ * relative decrease in mean error below which a coarse level is considered converged
+ * @var ICPConfig::coarse_seed
+ * seed for the (random) order in which source points are activated
+ * @var ICPConfig::nn_epsilon
+ * relative error tolerance of the nearest-neighbor search during icp iterations: each match is
+ * at most (1 + nn_epsilon) times farther than the true nearest neighbor {>= 0; 0 is exact}
+ * @var ICPConfig::max_correspondence_distance
+ * if positive, matches are searched only within this distance using a voxel hash (see
+ * `VoxelHash`) instead of the KD-tree, and source points without a match are rejected
+ * @var ICPConfig::nn_cache_size
+ * number of candidate neighbors remembered per source point between iterations of exact searches
+ * with the parallel searcher (see `NeighborCache`); a point that has not moved far enough to
+ * change its nearest neighbor is matched without searching the kd-tree {< NeighborCache::max_k;
+ * 0 disables the cache}
+ * @var ICPConfig::abort_epsilon
+ * inlier threshold for the early-abort bound {> 0 enables the bound; 0 disables it}
+ * @var ICPConfig::abort_min_inliers
+ * number of inliers (within `abort_epsilon`) a run must be able to reach to be worth finishing,
+ * e.g. one more than the best hypothesis so far
+ * @var ICPConfig::abort_after
+ * number of iterations run before the bound is checked (then, at every iteration) {>= 1}
+ * @var ICPConfig::abort_heuristic_margin
+ * factor by which the inlier count is assumed to be able to grow from its current value {>= 1}:
+ * a run is aborted once `abort_heuristic_margin` times the current number of inliers (scaled to
+ * the full source during the coarse-to-fine schedule) is less than `abort_min_inliers`.  This is
+ * a lossy heuristic, not a bound: the inlier count of an unfinished run can grow by any factor,
+ * so a run that would have reached `abort_min_inliers` may be aborted
+ * @var ICPConfig::inlier_epsilon
+ * if positive, a converged run also reports the number of source points whose nearest target
+ * point is within this distance at the returned transformation (`ICPStats::inliers`), counted
+ * from the distances of the last iteration
+ */
+struct ICPConfig {
+  ICPConfig() {
+    set_defaults();
+  }
+
+  void set_defaults() noexcept {
+    max_its = 100;
+    tolerance = 1e-8;
+    reject_ratio = 0.2;
+    method = icp_method_e::point_to_point;
+    normal_neighbors = 10;
+    covariance_epsilon = 1e-3;
+    anderson_depth = 0;
+    coarse_fraction = 1;
+    coarse_growth = 4;
+    coarse_tolerance = 5e-2;
+    coarse_seed = 0;
+    nn_epsilon = 0;
+    max_correspondence_distance = 0;
+    nn_cache_size = 4;
+    abort_epsilon = 0;
+    abort_min_inliers = 0;
+    abort_after = 3;
+    abort_heuristic_margin = 2;
+    inlier_epsilon = 0;
+  }
+
+  size_t max_its;
+  double tolerance;
+  double reject_ratio;
+  icp_method_e method;
+  size_t normal_neighbors;
+  double covariance_epsilon;
+  size_t anderson_depth;
+  double coarse_fraction;
+  double coarse_growth;
+  double coarse_tolerance;
+  size_t coarse_seed;
+  double nn_epsilon;
+  double max_correspondence_distance;
+  size_t nn_cache_size;
+  double abort_epsilon;
+  size_t abort_min_inliers;
+  size_t abort_after;
+  double abort_heuristic_margin;
+  double inlier_epsilon;
+};
+
+/**
+ * @struct ICPStats
+ * @brief diagnostics reported by icp
+ *
+ * @var ICPStats::iterations
+ * number of iterations run (including the one that detected convergence)
+ * @var ICPStats::anderson_resets
+ * number of accelerated steps rejected by the safeguard (each costs one iteration)
+ * @var ICPStats::nn_queries
+ * total number of nearest-neighbor queries (source points searched, summed over iterations)
+ * @var ICPStats::nn_tree_searches
+ * number of those queries that searched the kd-tree (all of them, unless matches are
+ * warm-started from `ICPConfig::nn_cache_size` cached candidates)
+ * @var ICPStats::aborted
+ * true if the run was abandoned by the early-abort bound (see `ICPConfig::abort_epsilon`)
+ * @var ICPStats::counted_inliers
+ * true if `inliers` holds the inlier count at the returned transformation: the run converged,
+ * `ICPConfig::inlier_epsilon` is positive, and the last matches were exact (`nn_epsilon == 0`
+ * and, with a voxel index, `max_correspondence_distance >= inlier_epsilon`)
+ * @var ICPStats::inliers
+ * number of source points within `ICPConfig::inlier_epsilon` of the target (if `counted_inliers`)
+ */
+struct ICPStats {
+  size_t iterations = 0;
+  size_t anderson_resets = 0;
+  size_t nn_queries = 0;
+  size_t nn_tree_searches = 0;
+  bool aborted = false;
+  bool counted_inliers = false;
+  size_t inliers = 0;
+};
+
+/**
+ * @brief Estimate unit surface normals from the covariance of nearest neighbors
+ *
+ * @param [in] pts points to estimate normals for
+ * @param [in] searcher nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in][out] normals normal at each point (columnar); sign is arbitrary
+ * @return
+ *
+ * @note normals are zero where fewer than three neighbors are available or the
+ * eigendecomposition fails; such points do not contribute to point_to_plane fits
+ */
+void estimate_normals(arma::mat const & pts, KDTreeSearcher & searcher, size_t const & k,
+    arma::mat & normals) noexcept;
+
+/**
+ * @brief Estimate unit surface normals from the covariance of nearest neighbors, with the
+ * neighbors of all points found in parallel
+ *
+ * @param [in] pts points to estimate normals for
+ * @param [in] searcher parallel nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in][out] normals normal at each point (columnar); sign is arbitrary
+ * @return
+ */
+void estimate_normals(arma::mat const & pts, ParallelSearcher const & searcher, size_t const & k,
+    arma::mat & normals) noexcept;
+
+/**
+ * @brief Estimate per-point (plane-to-plane) covariances for generalized icp: the covariance of
+ * nearest neighbors with its eigenvalues replaced by (epsilon, 1, 1)
+ *
+ * @param [in] pts points to estimate covariances for
+ * @param [in] searcher nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in] epsilon variance along the surface normal
+ * @param [in][out] covs covariance at each point (one slice per point)
+ * @return
+ *
+ * @note covariances are the identity (i.e. point-to-point) where fewer than three neighbors are
+ * available or the eigendecomposition fails
+ */
+void estimate_covariances(arma::mat const & pts, KDTreeSearcher & searcher, size_t const & k,
+    double const & epsilon, arma::cube & covs) noexcept;
+
+/**
+ * @brief Estimate per-point (plane-to-plane) covariances for generalized icp, with the neighbors
+ * of all points found in parallel
+ *
+ * @param [in] pts points to estimate covariances for
+ * @param [in] searcher parallel nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in] epsilon variance along the surface normal
+ * @param [in][out] covs covariance at each point (one slice per point)
+ * @return
+ */
+void estimate_covariances(arma::mat const & pts, ParallelSearcher const & searcher,
+    size_t const & k, double const & epsilon, arma::cube & covs) noexcept;
+
+/**
+ * @class ICPTarget
+ * @brief target points for icp with cached nearest-neighbor searchers and, if the configuration
+ * needs them, cached normals or covariances and a fixed-radius voxel index; build once per target
+ * and reuse across icp calls
+ */
+class ICPTarget {
+ public:
+   /** ICPTarget::ICPTarget(dst_pts, config)
+    * @brief constructor; builds the parallel exact searcher (`config.nn_epsilon == 0`) or the
+    * mlpack searcher (otherwise, for approximate matches) and, if needed, estimates normals or
+    * covariances and builds the voxel index (`config.max_correspondence_distance > 0`)
+    *
+    * @param [in] dst_pts target points
+    * @param [in] config icp configuration (determines which data is cached)
+    * @return
+    */
+   ICPTarget(arma::mat const & dst_pts, ICPConfig const & config)
+     : points_(dst_pts) {
+     //! only approximate matches need mlpack's (single-threaded) kd-tree
+     if (config.nn_epsilon == 0) {
+       parallel_searcher_ = ParallelSearcher(points_);
+     } else {
+       searcher_.Train(points_);
+       searcher_trained_ = true;
+     }
+     if (config.method == icp_method_e::point_to_plane) {
+       if (config.nn_epsilon == 0) {
+         estimate_normals(points_, parallel_searcher_, config.normal_neighbors, normals_);
+       } else {
+         estimate_normals(points_, searcher_, config.normal_neighbors, normals_);
+       }
+     } else if (config.method == icp_method_e::gicp) {
+       if (config.nn_epsilon == 0) {
+         estimate_covariances(points_, parallel_searcher_, config.normal_neighbors,
+             config.covariance_epsilon, covariances_);
+       } else {
+         estimate_covariances(points_, searcher_, config.normal_neighbors,
+             config.covariance_epsilon, covariances_);
+       }
+     }
+     if (config.max_correspondence_distance > 0) {
+       voxels_ = VoxelHash(points_, config.max_correspondence_distance);
+     }
+   }
+
+   /** ICPTarget::points()
+    * @brief get target points
+    *
+    * @param[in]
+    * @return const reference to target points
+    */
+   arma::mat const & points() const noexcept { return points_; }
+
+   /** ICPTarget::normals()
+    * @brief get target normals
+    *
+    * @param[in]
+    * @return const reference to target normals (empty if not estimated)
+    */
+   arma::mat const & normals() const noexcept { return normals_; }
+
+   /** ICPTarget::covariances()
+    * @brief get target covariances
+    *
+    * @param[in]
+    * @return const reference to target covariances (empty if not estimated)
+    */
+   arma::cube const & covariances() const noexcept { return covariances_; }
+
+   /** ICPTarget::searcher()
+    * @brief get nearest-neighbor searcher for target points
+    *
+    * @param[in]
+    * @return reference to searcher (without reference points unless `config.nn_epsilon > 0`)
+    * @note non-const: mlpack searches are not const (and not thread-safe)
+    */
+   KDTreeSearcher & searcher() noexcept { return searcher_; }
+
+   /** ICPTarget::searcher_trained()
+    * @brief check whether the mlpack searcher was built on the target points
+    *
+    * @param[in]
+    * @return true if the target was built with `config.nn_epsilon > 0`, false otherwise
+    */
+   bool searcher_trained() const noexcept { return searcher_trained_; }
+
+   /** ICPTarget::voxels()
+    * @brief get fixed-radius voxel index of target points
+    *
+    * @param[in]
+    * @return const reference to voxel index (empty if not built)
+    */
+   VoxelHash const & voxels() const noexcept { return voxels_; }
+
+   /** ICPTarget::parallel_searcher()
+    * @brief get parallel exact nearest-neighbor searcher for target points
+    *
+    * @param[in]
+    * @return const reference to searcher (empty unless `config.nn_epsilon == 0`)
+    */
+   ParallelSearcher const & parallel_searcher() const noexcept { return parallel_searcher_; }
+
+ private:
+   arma::mat points_;
+   arma::mat normals_;
+   arma::cube covariances_;
+   KDTreeSearcher searcher_;
+   VoxelHash voxels_;
+   ParallelSearcher parallel_searcher_;
+   bool searcher_trained_ = false;
+};
+
 /**
  * @brief Iterative closest point algorithm: Perform point-set alignment two sets of points with outlier rejection.
  *
@@ -25,8 +353,90 @@ using KDTreeSearcher = mlpack::neighbor::NeighborSearch<
  * @param [in] reject_ratio ratio of worst-matches to reject in fit
  * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
  * @return
+ *
+ * @note the transformed source points, index lists, and nearest-neighbor outputs are allocated
+ * once per call; iterations only compose the (rigid) transformation and update them in place
  */
 bool iterative_closest_point(arma::mat const & src_pts, arma::mat const & dst_pts,
     arma::mat44 & H_init, size_t const & max_its, double const & tolerance,
     double const & reject_ratio, arma::mat44 & H_optimal) noexcept;
+
+/**
+ * @brief Iterative closest point algorithm against a prebuilt target
+ *
+ * @param [in] src_pts points to transform
+ * @param [in][out] target target points with cached searcher (and normals); see `ICPTarget`
+ * @param [in] H_init initial guess for best-fit homogeneous transformation
+ * @param [in] config icp configuration; see `ICPConfig`
+ * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @param [in][out] stats (optional) diagnostics; see `ICPStats`
+ * @return true if converged within `config.max_its` iterations, false otherwise
+ *
+ * @note for `icp_method_e::gicp`, source covariances are estimated on every call; use
+ * `generalized_icp` with precomputed source covariances when aligning the same source repeatedly
+ * @note if `config.anderson_depth > 0`, transformation updates are Anderson-accelerated; an
+ * accelerated step that increases the (trimmed) squared error is replaced by the plain step
+ * @note if `config.coarse_fraction < 1`, early iterations use a random subset of the source that
+ * grows geometrically as the error settles; only the final iterations use the full source
+ * @note if `config.nn_epsilon > 0`, matches come from an approximate search on the target's
+ * searcher, so the target must have been built with `nn_epsilon > 0` too (the call fails
+ * otherwise); the searcher is restored to its previous (by default, exact) setting on return
+ * @note if `config.max_correspondence_distance > 0`, matches come from the target's voxel index,
+ * which must have been built with (at least) that radius
+ * @note otherwise, exact matches come from the target's parallel searcher if it was built, and
+ * from its (single-threaded) mlpack searcher if not; with the parallel searcher, each source point
+ * first tries the neighbors cached at its last kd-tree search (`config.nn_cache_size`)
+ * @note if `config.abort_epsilon > 0`, the run is abandoned (returning false) as soon as it
+ * looks unlikely to reach `config.abort_min_inliers` inliers; this is a heuristic that can drop
+ * runs which would have reached it, see `ICPConfig::abort_heuristic_margin`
+ * @note if `config.inlier_epsilon > 0`, the inlier count at the returned transformation is taken
+ * from the distances computed by the last iteration (no extra search); see `ICPStats::inliers`
+ */
+bool iterative_closest_point(arma::mat const & src_pts, ICPTarget & target,
+    arma::mat44 const & H_init, ICPConfig const & config, arma::mat44 & H_optimal,
+    ICPStats * stats = nullptr) noexcept;
+
+/**
+ * @brief Generalized icp (plane-to-plane) against a prebuilt target with precomputed source
+ * covariances
+ *
+ * @param [in] src_pts points to transform
+ * @param [in] src_covs source covariances; see `estimate_covariances`
+ * @param [in][out] target target points with cached searcher and covariances; see `ICPTarget`
+ * @param [in] H_init initial guess for best-fit homogeneous transformation
+ * @param [in] config icp configuration; see `ICPConfig` (`method` is ignored)
+ * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @param [in][out] stats (optional) diagnostics; see `ICPStats`
+ * @return true if converged within `config.max_its` iterations, false otherwise
+ */
+bool generalized_icp(arma::mat const & src_pts, arma::cube const & src_covs, ICPTarget & target,
+    arma::mat44 const & H_init, ICPConfig const & config, arma::mat44 & H_optimal,
+    ICPStats * stats = nullptr) noexcept;
+
+/**
+ * @brief Iterative closest point for several initial transformations (hypotheses) of the same
+ * source against a prebuilt target, refined in lock step
+ *
+ * @param [in] src_pts points to transform
+ * @param [in][out] target target points with cached searcher (and normals); see `ICPTarget`
+ * @param [in] H_init initial guesses for best-fit homogeneous transformations (one slice each)
+ * @param [in] config icp configuration; see `ICPConfig`
+ * @param [in][out] H_optimal best-fit transformation of each hypothesis (one slice each)
+ * @param [in][out] converged 1 for each hypothesis that converged within `config.max_its`
+ * iterations, 0 otherwise
+ * @param [in][out] stats (optional) diagnostics of each hypothesis; see `ICPStats`
+ * @return number of hypotheses that converged
+ *
+ * @note each hypothesis follows `iterative_closest_point` (same trimming, convergence test, early
+ * abort, and inlier count), so results agree up to rounding; hypotheses leave the batch as they
+ * converge, are aborted, or run out of iterations
+ * @note per iteration, the queries of all remaining hypotheses are searched as one batch, ordered
+ * so that consecutive queries are close in space
+ * @note lock step needs the target's parallel searcher and exact point_to_point or point_to_plane
+ * matching without Anderson acceleration or a coarse-to-fine schedule; other configurations run
+ * the hypotheses one after another
+ */
+size_t iterative_closest_points(arma::mat const & src_pts, ICPTarget & target,
+    arma::cube const & H_init, ICPConfig const & config, arma::cube & H_optimal,
+    arma::uvec & converged, std::vector<ICPStats> * stats = nullptr) noexcept;
 }  // namespace transforms
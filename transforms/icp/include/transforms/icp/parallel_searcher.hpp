@@ -0,0 +1,251 @@
+#pragma once
+//! c/c++ headers
+#include <cstdint>
+#include <vector>
+//! dependency headers
+#include <armadillo>
+//! project headers
+#include "transforms/common/point_cloud.hpp"
+
+namespace transforms {
+/**
+ * @struct NeighborCache
+ * @brief per-query state for warm-started nearest-neighbor searches of queries that move a little
+ * between searches (e.g. source points across icp iterations); see `ParallelSearcher::search`
+ *
+ * @var NeighborCache::max_k
+ * upper bound (exclusive) on the number of candidates per query
+ * @var NeighborCache::k
+ * number of candidates kept per query {\in [1, max_k)}; more candidates let a query move farther
+ * before the kd-tree is searched again, at the cost of a slightly more expensive refresh
+ * @var NeighborCache::anchors
+ * position of each query at its last kd-tree search
+ * @var NeighborCache::candidates
+ * the k nearest neighbors of each anchor (k x no. of queries), as columns of the searcher's
+ * internal dataset; only meaningful to the searcher that filled the cache
+ * @var NeighborCache::radii
+ * distance from each anchor to its (k + 1)-th nearest neighbor (infinite if there is none,
+ * negative if the entry is invalid)
+ * @var NeighborCache::searched
+ * for each query, 1 if it searched the kd-tree in the last call, 0 if it was answered from the
+ * cache
+ */
+struct NeighborCache {
+  static constexpr size_t max_k = 16;
+  size_t k = 4;
+  arma::mat anchors;
+  arma::Mat<size_t> candidates;
+  arma::vec radii;
+  std::vector<uint8_t> searched;
+
+  /** NeighborCache::reset()
+   * @brief invalidate all entries (e.g. before reuse with another searcher)
+   *
+   * @param[in]
+   * @return
+   */
+  void reset() noexcept {
+    anchors.reset();
+    candidates.reset();
+    radii.reset();
+    searched.clear();
+  }
+};
+
+/**
+ * @class ParallelSearcher
+ *
+ * @brief exact nearest-neighbor search that splits the queries into blocks and runs the blocks on
+ * all threads against one shared, read-only kd-tree
+ *
+ * @note mlpack's `NeighborSearch::Search` is neither const nor thread-safe (dual-tree search
+ * updates statistics stored in the reference tree), and its tree is built on one thread with
+ * pointer-linked nodes, so the searcher keeps its own kd-tree: nodes live in one array in
+ * depth-first order (the left child of a node follows it directly), each with a tight bounding
+ * box, and the points are copied into leaf order (as a structure-of-arrays `PointCloud`) so every
+ * leaf is a contiguous block of x, y and z values
+ * @note the tree splits every node at the median of its widest dimension, so its shape (and the
+ * array slot of every node) depends only on the number of points; subtrees are built as
+ * independent tasks on all threads, each writing its own slots, and the result does not depend
+ * on the number of threads
+ * @note queries descend the kd-tree nearer child first, pruning nodes whose bounding box is no
+ * closer than the best match so far
+ * @note each query is answered independently and written to its own column, so the output does
+ * not depend on the number of threads or on scheduling; ties go to the first point reached
+ */
+class ParallelSearcher {
+ public:
+   /** ParallelSearcher::ParallelSearcher()
+    * @brief default constructor; creates an empty searcher (all queries fail)
+    *
+    * @param[in]
+    * @return
+    */
+   ParallelSearcher() { }
+
+   /** ParallelSearcher::ParallelSearcher(pts, leaf_size)
+    * @brief constructor; builds the kd-tree (in parallel)
+    *
+    * @param[in] pts reference points (columnar, 3 rows)
+    * @param[in] leaf_size maximum number of points in a leaf
+    * @return
+    */
+   explicit ParallelSearcher(arma::mat const & pts, size_t const & leaf_size = 20) noexcept;
+
+   /** ParallelSearcher::nearest(query, index, distance)
+    * @brief find the nearest reference point of a query point
+    *
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in][out] index column of nearest point in the `pts` used to build the searcher
+    * @param[in][out] distance distance to nearest point
+    * @return true if there is a reference point, false otherwise (outputs untouched)
+    */
+   bool nearest(double const * query, size_t & index, double & distance) const noexcept;
+
+   /** ParallelSearcher::nearest(query, m, indices, distances_sq)
+    * @brief find the m nearest reference points of a query point
+    *
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in] m number of neighbors to find
+    * @param[in][out] indices columns of nearest points in the `pts` used to build the searcher,
+    * nearest first (room for m values)
+    * @param[in][out] distances_sq squared distances to nearest points, ascending (room for m
+    * values)
+    * @return number of neighbors found (min(m, size()) for finite queries)
+    */
+   size_t nearest(double const * query, size_t const & m, size_t * indices,
+       double * distances_sq) const noexcept;
+
+   /** ParallelSearcher::search(queries, neighbors, distances, block_size)
+    * @brief batched nearest-neighbor search, with the same output layout as
+    * `KDTreeSearcher::Search` for k = 1
+    *
+    * @param[in] queries query points (columnar, 3 rows)
+    * @param[in][out] neighbors nearest reference point for each query (1 x no. of queries);
+    * reallocated only if its size differs
+    * @param[in][out] distances distance to nearest reference point (1 x no. of queries);
+    * reallocated only if its size differs
+    * @param[in] block_size no. of queries handed to a thread at a time
+    * @return
+    */
+   void search(arma::mat const & queries, arma::Mat<size_t> & neighbors, arma::mat & distances,
+       size_t const & block_size = 256) const noexcept;
+
+   /** ParallelSearcher::search(queries, k, neighbors, distances, block_size)
+    * @brief batched k-nearest-neighbor search, with the same output layout as
+    * `KDTreeSearcher::Search`
+    *
+    * @param[in] queries query points (columnar, 3 rows)
+    * @param[in] k number of neighbors to find for each query
+    * @param[in][out] neighbors nearest reference points for each query, nearest first
+    * (k x no. of queries); missing neighbors are `size()`
+    * @param[in][out] distances distances to nearest reference points, ascending
+    * (k x no. of queries); missing neighbors are infinitely far away
+    * @param[in] block_size no. of queries handed to a thread at a time
+    * @return
+    */
+   void search(arma::mat const & queries, size_t const & k, arma::Mat<size_t> & neighbors,
+       arma::mat & distances, size_t const & block_size = 256) const noexcept;
+
+   /** ParallelSearcher::search(queries, cache, neighbors, distances, block_size)
+    * @brief batched nearest-neighbor search, warm-started from the neighbors found for the same
+    * queries at earlier positions
+    *
+    * @param[in] queries query points (columnar, 3 rows); column i is the (moved) query i of the
+    * previous call with the same cache
+    * @param[in][out] cache candidate neighbors of each query; see `NeighborCache`
+    * @param[in][out] neighbors nearest reference point for each query (1 x no. of queries);
+    * reallocated only if its size differs
+    * @param[in][out] distances distance to nearest reference point (1 x no. of queries);
+    * reallocated only if its size differs
+    * @param[in] block_size no. of queries handed to a thread at a time
+    * @return number of queries that needed a search of the kd-tree
+    *
+    * @note a query is answered from its cached candidates when the triangle inequality proves
+    * that no other reference point can be closer, and searches the kd-tree (refreshing its cache
+    * entry) otherwise; distances are exact either way
+    * @note queries added since the previous call (more columns) start with invalid entries
+    */
+   size_t search(arma::mat const & queries, NeighborCache & cache, arma::Mat<size_t> & neighbors,
+       arma::mat & distances, size_t const & block_size = 256) const noexcept;
+
+   /** ParallelSearcher::num_nodes()
+    * @brief get number of kd-tree nodes
+    *
+    * @param[in]
+    * @return number of nodes (0 for an empty searcher)
+    */
+   size_t num_nodes() const noexcept { return nodes_.size(); }
+
+   /** ParallelSearcher::size()
+    * @brief get number of reference points
+    *
+    * @param[in]
+    * @return number of reference points
+    */
+   size_t size() const noexcept { return old_from_new_.size(); }
+
+ private:
+   /**
+    * @struct Node
+    * @brief kd-tree node: bounding box of its points and the block of (leaf-ordered) columns
+    * they occupy; the left child is the next node in the array, `right` is the slot of the right
+    * child (0 for a leaf)
+    */
+   struct Node {
+     double lo[3];
+     double hi[3];
+     size_t begin;
+     size_t count;
+     size_t right;
+   };
+
+   /** ParallelSearcher::build(pts, order, slot, begin, count, leaf_size)
+    * @brief build the subtree over columns [begin, begin + count) of `order` into the slots
+    * starting at `slot`, spawning a task for large subtrees
+    *
+    * @param[in] pts reference points (columnar, 3 rows)
+    * @param[in][out] order column of `pts` at each position; rearranged so that every subtree is
+    * a contiguous range
+    * @param[in] slot array slot of the subtree's root
+    * @param[in] begin first position of the subtree's points in `order`
+    * @param[in] count number of points in the subtree
+    * @param[in] leaf_size maximum number of points in a leaf
+    * @return
+    */
+   void build(arma::mat const & pts, std::vector<size_t> & order, size_t const & slot,
+       size_t const & begin, size_t const & count, size_t const & leaf_size) noexcept;
+
+   /** ParallelSearcher::descend(slot, node_d_sq, query, m, indices, distances_sq, found)
+    * @brief depth-first m-nearest-neighbor descent: nearer child first, prune by box distance
+    *
+    * @param[in] slot array slot of the node
+    * @param[in] node_d_sq squared distance from the query to the node's bounding box
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in] m number of neighbors to find
+    * @param[in][out] indices columns of best matches so far in the tree's dataset
+    * @param[in][out] distances_sq squared distances to best matches so far (ascending)
+    * @param[in][out] found number of best matches so far
+    * @return
+    */
+   void descend(size_t const & slot, double const & node_d_sq, double const * query,
+       size_t const & m, size_t * indices, double * distances_sq, size_t & found) const noexcept;
+
+   /** ParallelSearcher::nearest_in_tree(query, m, indices, distances_sq)
+    * @brief find the m nearest reference points of a query point, as columns of the kd-tree's
+    * (rearranged) dataset
+    *
+    * @param[in] query pointer to query point (3 contiguous values)
+    * @param[in] m number of neighbors to find
+    * @param[in][out] indices columns of nearest points in the tree's dataset, nearest first
+    * @param[in][out] distances_sq squared distances to nearest points, ascending
+    * @return number of neighbors found
+    */
+   size_t nearest_in_tree(double const * query, size_t const & m, size_t * indices,
+       double * distances_sq) const noexcept;
+
+   std::vector<Node> nodes_;  //! kd-tree nodes, depth-first (root first)
+   PointCloud points_;  //! reference points in leaf order
+   std::vector<size_t> old_from_new_;  //! original column of each point in `points_`
+};
+}  // namespace transforms
@@ -1,25 +1,509 @@
 //! c/c++ headers
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
 //! dependency headers
 //! project headers
+#include "transforms/common/cell_grid.hpp"  // for morton_order declaration
 #include "transforms/icp/icp.hpp"
-#include "transforms/svd/svd.hpp"  // for best_fit_transform declaration
+#include "transforms/svd/svd.hpp"  // for best_fit_from_covariance declaration
 
+namespace {
 /**
- * @brief Iterative closest point algorithm: Perform point-set alignment on two sets of points with outlier rejection.
+ * @brief Rotation matrix from rotation vector (Rodrigues' formula)
  *
- * @param [in] src_pts points to transform
+ * @param [in] w rotation vector (axis times angle)
+ * @param [in][out] R rotation matrix
+ * @return
+ */
+void rotation_from_vector(arma::vec3 const & w, arma::mat33 & R) noexcept {
+  double const theta = arma::norm(w, 2);
+  arma::mat33 const K = {{0, -w(2), w(1)}, {w(2), 0, -w(0)}, {-w(1), w(0), 0}};
+  R.eye();
+  if (theta < std::numeric_limits<double>::epsilon()) {
+    R += K;
+    return;
+  }
+  R += (std::sin(theta) / theta) * K + ((1. - std::cos(theta)) / (theta * theta)) * K * K;
+  return;
+}
+
+/**
+ * @brief Rotation vector (axis times angle) from rotation matrix; inverse of
+ * `rotation_from_vector` for angles in [0, pi]
+ *
+ * @param [in] R rotation matrix
+ * @param [in][out] w rotation vector
+ * @return
+ */
+void rotation_to_vector(arma::mat33 const & R, arma::vec3 & w) noexcept {
+  double const cos_theta = std::max(-1., std::min(1., 0.5 * (arma::trace(R) - 1.)));
+  double const theta = std::acos(cos_theta);
+  arma::vec3 const v = {R(2, 1) - R(1, 2), R(0, 2) - R(2, 0), R(1, 0) - R(0, 1)};
+  if (theta < 1e-6) {
+    w = 0.5 * v;
+  } else if (M_PI - theta < 1e-6) {
+    //! R ~ 2*a*a.t() - I: the axis is the normalized column with the largest diagonal entry
+    arma::uword const i = R.diag().index_max();
+    arma::vec3 a = R.col(i);
+    a(i) += 1.;
+    w = theta * arma::normalise(a);
+  } else {
+    w = (0.5 * theta / std::sin(theta)) * v;
+  }
+  return;
+}
+
+/**
+ * @brief Solve symmetric positive-definite 6x6 system A*x = b by Cholesky decomposition
+ *
+ * @param [in] A symmetric matrix
+ * @param [in] b right-hand side
+ * @param [in][out] x solution
+ * @return true if A is (numerically) positive-definite, false otherwise
+ */
+bool solve_spd(arma::mat66 const & A, arma::vec6 const & b, arma::vec6 & x) noexcept {
+  double const min_pivot = 1e-12 * std::max(arma::max(A.diag()), 1.);
+  arma::mat66 L(arma::fill::zeros);
+  for (size_t j = 0; j < 6; ++j) {
+    double d = A(j, j);
+    for (size_t k = 0; k < j; ++k) {
+      d -= L(j, k) * L(j, k);
+    }
+    if (d <= min_pivot) {
+      return false;
+    }
+    L(j, j) = std::sqrt(d);
+    for (size_t i = j + 1; i < 6; ++i) {
+      double s = A(i, j);
+      for (size_t k = 0; k < j; ++k) {
+        s -= L(i, k) * L(j, k);
+      }
+      L(i, j) = s / L(j, j);
+    }
+  }
+
+  //! forward (L*y = b) then backward (L.t()*x = y) substitution
+  for (size_t i = 0; i < 6; ++i) {
+    double s = b(i);
+    for (size_t k = 0; k < i; ++k) {
+      s -= L(i, k) * x(k);
+    }
+    x(i) = s / L(i, i);
+  }
+  for (size_t i = 6; i-- > 0; ) {
+    double s = x(i);
+    for (size_t k = i + 1; k < 6; ++k) {
+      s -= L(k, i) * x(k);
+    }
+    x(i) = s / L(i, i);
+  }
+  return true;
+}
+
+/**
+ * @brief Best rigid (incremental) transformation minimizing point-to-point error over the
+ * retained matches
+ *
+ * @param [in] src_xform current transformed source points
  * @param [in] dst_pts target points
- * @param [in] H_init initial guess for best-fit homogeneous transformation
- * @param [in] max_its maximum number of iterations
- * @param [in] tolerance criteria for convergence, in terms of mean error between iterations
- * @param [in] reject_ratio ratio of worst-matches to reject in fit
- * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @param [in] neighbors nearest target point for each source point
+ * @param [in] src_idx source indices; the first `n_keep` are the retained matches
+ * @param [in] n_keep number of retained matches
+ * @param [in][out] R incremental rotation
+ * @param [in][out] t incremental translation
  * @return
  */
-bool transforms::iterative_closest_point(arma::mat const & src_pts, arma::mat const & dst_pts,
-    arma::mat44 & H_init, size_t const & max_its, double const & tolerance,
-    double const & reject_ratio, arma::mat44 & H_optimal) noexcept {
+void point_to_point_step(arma::mat const & src_xform, arma::mat const & dst_pts,
+    arma::Mat<size_t> const & neighbors, std::vector<size_t> const & src_idx,
+    size_t const & n_keep, arma::mat33 & R, arma::vec3 & t) noexcept {
+  //! centroids of retained matches (no gather)
+  arma::vec3 src_centroid(arma::fill::zeros), dst_centroid(arma::fill::zeros);
+  for (size_t k = 0; k < n_keep; ++k) {
+    size_t const i = src_idx[k];
+    double const * s = src_xform.colptr(i);
+    double const * d = dst_pts.colptr(neighbors(0, i));
+    for (size_t r = 0; r < 3; ++r) {
+      src_centroid(r) += s[r];
+      dst_centroid(r) += d[r];
+    }
+  }
+  src_centroid /= static_cast<double>(n_keep);
+  dst_centroid /= static_cast<double>(n_keep);
+
+  //! cross-covariance of retained matches
+  arma::mat33 C(arma::fill::zeros);
+  for (size_t k = 0; k < n_keep; ++k) {
+    size_t const i = src_idx[k];
+    double const * s = src_xform.colptr(i);
+    double const * d = dst_pts.colptr(neighbors(0, i));
+    for (size_t c = 0; c < 3; ++c) {
+      double const dc = d[c] - dst_centroid(c);
+      for (size_t r = 0; r < 3; ++r) {
+        C(r, c) += (s[r] - src_centroid(r)) * dc;
+      }
+    }
+  }
+  transforms::best_fit_from_covariance(C, src_centroid, dst_centroid, R, t);
+  return;
+}
+
+/**
+ * @brief Rigid (incremental) transformation minimizing linearized point-to-plane error over the
+ * retained matches
+ *
+ * @param [in] src_xform current transformed source points
+ * @param [in] dst_pts target points
+ * @param [in] dst_normals target normals
+ * @param [in] neighbors nearest target point for each source point
+ * @param [in] src_idx source indices; the first `n_keep` are the retained matches
+ * @param [in] n_keep number of retained matches
+ * @param [in][out] R incremental rotation
+ * @param [in][out] t incremental translation
+ * @return true if the normal equations are well-posed, false otherwise
+ *
+ * @note residual n.t()*(R*s + t - d) is linearized about R = I: n.t()*(s - d) +
+ * (s x n).t()*w + n.t()*t, with w the rotation vector
+ */
+bool point_to_plane_step(arma::mat const & src_xform, arma::mat const & dst_pts,
+    arma::mat const & dst_normals, arma::Mat<size_t> const & neighbors,
+    std::vector<size_t> const & src_idx, size_t const & n_keep, arma::mat33 & R,
+    arma::vec3 & t) noexcept {
+  arma::mat66 A(arma::fill::zeros);
+  arma::vec6 b(arma::fill::zeros);
+  arma::vec6 J;
+  for (size_t k = 0; k < n_keep; ++k) {
+    size_t const i = src_idx[k];
+    size_t const j = neighbors(0, i);
+    double const * s = src_xform.colptr(i);
+    double const * d = dst_pts.colptr(j);
+    double const * n = dst_normals.colptr(j);
+    J(0) = s[1] * n[2] - s[2] * n[1];
+    J(1) = s[2] * n[0] - s[0] * n[2];
+    J(2) = s[0] * n[1] - s[1] * n[0];
+    J(3) = n[0];
+    J(4) = n[1];
+    J(5) = n[2];
+    double const residual = n[0] * (s[0] - d[0]) + n[1] * (s[1] - d[1]) + n[2] * (s[2] - d[2]);
+    //! lower triangle suffices for Cholesky
+    for (size_t c = 0; c < 6; ++c) {
+      for (size_t r = c; r < 6; ++r) {
+        A(r, c) += J(r) * J(c);
+      }
+      b(c) -= J(c) * residual;
+    }
+  }
+
+  arma::vec6 x;
+  if (!solve_spd(A, b, x)) {
+    return false;
+  }
+  arma::vec3 const w = x.head(3);
+  rotation_from_vector(w, R);
+  t = x.tail(3);
+  return true;
+}
+
+/**
+ * @brief Covariance of the k nearest neighbors of each point
+ *
+ * @param [in] pts points
+ * @param [in] neighbors k nearest neighbors of each point (k x no. of points)
+ * @param [in][out] covs (unnormalized) covariance at each point (one slice per point)
+ * @return false if fewer than three neighbors are available, true otherwise
+ */
+bool local_covariances(arma::mat const & pts, arma::Mat<size_t> const & neighbors,
+    arma::cube & covs) noexcept {
+  size_t const n_nbrs = neighbors.n_rows;
+  if (n_nbrs < 3 || neighbors.n_cols != pts.n_cols) {
+    return false;
+  }
+
+  covs.zeros(3, 3, pts.n_cols);
+  for (size_t i = 0; i < pts.n_cols; ++i) {
+    arma::vec3 mean(arma::fill::zeros);
+    for (size_t q = 0; q < n_nbrs; ++q) {
+      mean += pts.col(neighbors(q, i));
+    }
+    mean /= static_cast<double>(n_nbrs);
+    for (size_t q = 0; q < n_nbrs; ++q) {
+      arma::vec3 const dev = pts.col(neighbors(q, i)) - mean;
+      covs.slice(i) += dev * dev.t();
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Unit surface normals from the covariance of nearest neighbors
+ *
+ * @param [in] pts points
+ * @param [in] neighbors k nearest neighbors of each point (k x no. of points)
+ * @param [in][out] normals normal at each point (columnar; zero where unavailable)
+ * @return
+ */
+void normals_from_neighbors(arma::mat const & pts, arma::Mat<size_t> const & neighbors,
+    arma::mat & normals) noexcept {
+  normals.zeros(3, pts.n_cols);
+  arma::cube covs;
+  if (!local_covariances(pts, neighbors, covs)) {
+    return;
+  }
+
+  arma::vec3 eigval;
+  arma::mat33 eigvec;
+  for (size_t i = 0; i < pts.n_cols; ++i) {
+    //! normal is the direction of least variance (eigenvalues are in ascending order)
+    if (arma::eig_sym(eigval, eigvec, arma::mat33(covs.slice(i)))) {
+      normals.col(i) = eigvec.col(0);
+    }
+  }
+  return;
+}
+
+/**
+ * @brief Plane-to-plane covariances from the covariance of nearest neighbors
+ *
+ * @param [in] pts points
+ * @param [in] neighbors k nearest neighbors of each point (k x no. of points)
+ * @param [in] epsilon variance along the surface normal
+ * @param [in][out] covs covariance at each point (one slice per point; identity where
+ * unavailable)
+ * @return
+ */
+void covariances_from_neighbors(arma::mat const & pts, arma::Mat<size_t> const & neighbors,
+    double const & epsilon, arma::cube & covs) noexcept {
+  arma::cube local;
+  bool const have_local = local_covariances(pts, neighbors, local);
+  covs.set_size(3, 3, pts.n_cols);
+
+  arma::vec3 const variances = {epsilon, 1, 1};
+  arma::vec3 eigval;
+  arma::mat33 eigvec;
+  for (size_t i = 0; i < pts.n_cols; ++i) {
+    if (have_local && arma::eig_sym(eigval, eigvec, arma::mat33(local.slice(i)))) {
+      covs.slice(i) = eigvec * arma::diagmat(variances) * eigvec.t();
+    } else {
+      covs.slice(i).eye();
+    }
+  }
+  return;
+}
+
+/**
+ * @brief k nearest neighbors of each point (including the point itself) from an mlpack searcher
+ *
+ * @param [in] pts points
+ * @param [in] searcher nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors
+ * @param [in][out] neighbors nearest neighbors (min(k, no. of points) x no. of points; empty if
+ * fewer than three neighbors are available)
+ * @return
+ */
+void local_neighbors(arma::mat const & pts, transforms::KDTreeSearcher & searcher,
+    size_t const & k, arma::Mat<size_t> & neighbors) noexcept {
+  size_t const n_nbrs = std::min(k, static_cast<size_t>(pts.n_cols));
+  if (n_nbrs < 3) {
+    neighbors.reset();
+    return;
+  }
+  arma::mat distances;
+  searcher.Search(pts, n_nbrs, neighbors, distances);
+  return;
+}
+
+/**
+ * @brief k nearest neighbors of each point (including the point itself) from a parallel searcher
+ *
+ * @param [in] pts points
+ * @param [in] searcher parallel nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors
+ * @param [in][out] neighbors nearest neighbors (min(k, no. of points) x no. of points; empty if
+ * fewer than three neighbors are available)
+ * @return
+ */
+void local_neighbors(arma::mat const & pts, transforms::ParallelSearcher const & searcher,
+    size_t const & k, arma::Mat<size_t> & neighbors) noexcept {
+  size_t const n_nbrs = std::min(k, static_cast<size_t>(pts.n_cols));
+  if (n_nbrs < 3 || searcher.size() != pts.n_cols) {
+    neighbors.reset();
+    return;
+  }
+  arma::mat distances;
+  searcher.search(pts, n_nbrs, neighbors, distances);
+  return;
+}
+
+/**
+ * @brief Rigid (incremental) transformation from one Gauss-Newton step on the generalized icp
+ * (plane-to-plane) objective over the retained matches
+ *
+ * @param [in] src_xform current transformed source points
+ * @param [in] src_covs source covariances (in the source frame)
+ * @param [in] dst_pts target points
+ * @param [in] dst_covs target covariances
+ * @param [in] R_total current total rotation (rotates source covariances into target frame)
+ * @param [in] neighbors nearest target point for each source point
+ * @param [in] src_idx source indices; the first `n_keep` are the retained matches
+ * @param [in] n_keep number of retained matches
+ * @param [in][out] R incremental rotation
+ * @param [in][out] t incremental translation
+ * @return true if the normal equations are well-posed, false otherwise
+ *
+ * @note minimizes sum_k r_k.t()*M_k*r_k with r_k = x_k - d_k and
+ * M_k = inv(C_d + R_total*C_s*R_total.t()); perturbations are applied on the left,
+ * x_k -> exp(w)*x_k + t, so the Jacobian of r_k is [-skew(x_k), I]
+ */
+bool gicp_step(arma::mat const & src_xform, arma::cube const & src_covs,
+    arma::mat const & dst_pts, arma::cube const & dst_covs, arma::mat33 const & R_total,
+    arma::Mat<size_t> const & neighbors, std::vector<size_t> const & src_idx,
+    size_t const & n_keep, arma::mat33 & R, arma::vec3 & t) noexcept {
+  arma::mat66 A(arma::fill::zeros);
+  arma::vec6 b(arma::fill::zeros);
+  arma::mat33 M;
+  arma::mat::fixed<3, 6> J(arma::fill::zeros);
+  J.cols(3, 5).eye();
+  for (size_t k = 0; k < n_keep; ++k) {
+    size_t const i = src_idx[k];
+    size_t const j = neighbors(0, i);
+    arma::vec3 const x = src_xform.col(i);
+    arma::vec3 const r = x - dst_pts.col(j);
+    arma::mat33 const C = dst_covs.slice(j) + R_total * src_covs.slice(i) * R_total.t();
+    if (!arma::inv_sympd(M, C)) {
+      continue;
+    }
+    //! rotational part of the Jacobian: -skew(x)
+    J(0, 1) = x(2);
+    J(0, 2) = -x(1);
+    J(1, 0) = -x(2);
+    J(1, 2) = x(0);
+    J(2, 0) = x(1);
+    J(2, 1) = -x(0);
+    arma::mat::fixed<6, 3> const JtM = J.t() * M;
+    A += JtM * J;
+    b -= JtM * r;
+  }
+
+  arma::vec6 w_t;
+  if (!solve_spd(A, b, w_t)) {
+    return false;
+  }
+  arma::vec3 const w = w_t.head(3);
+  rotation_from_vector(w, R);
+  t = w_t.tail(3);
+  return true;
+}
+
+/**
+ * @class AndersonAccelerator
+ * @brief Anderson acceleration (type II) of a fixed-point iteration u -> g(u) in R^6
+ *
+ * @note keeps the last `depth` differences of iterates and residuals f = g(u) - u in fixed-size
+ * ring buffers; the accelerated iterate is g - dG*gamma, with gamma minimizing ||f - dF*gamma||
+ */
+class AndersonAccelerator {
+ public:
+   /** AndersonAccelerator::AndersonAccelerator(depth)
+    * @brief constructor
+    *
+    * @param [in] depth number of previous iterates to use (0 disables acceleration)
+    * @return
+    */
+   explicit AndersonAccelerator(size_t const & depth)
+     : depth_(depth), dG_(6, depth), dF_(6, depth) {
+     reset();
+   }
+
+   /** AndersonAccelerator::enabled()
+    * @brief check whether acceleration is enabled
+    *
+    * @param[in]
+    * @return true if depth > 0, false otherwise
+    */
+   bool enabled() const noexcept { return depth_ > 0; }
+
+   /** AndersonAccelerator::reset()
+    * @brief discard history; the next call to `extrapolate` returns the plain iterate
+    *
+    * @param[in]
+    * @return
+    */
+   void reset() noexcept {
+     n_hist_ = 0;
+     head_ = 0;
+     has_prev_ = false;
+   }
+
+   /** AndersonAccelerator::extrapolate(u, g, u_acc)
+    * @brief add the iterate pair (u, g(u)) to the history and compute the accelerated iterate
+    *
+    * @param [in] u current iterate
+    * @param [in] g fixed-point map evaluated at `u`
+    * @param [in][out] u_acc accelerated iterate (only written if true is returned)
+    * @return true if an accelerated iterate was computed, false if the plain iterate should be
+    * used (no history yet or an ill-posed least-squares problem)
+    */
+   bool extrapolate(arma::vec6 const & u, arma::vec6 const & g, arma::vec6 & u_acc) noexcept {
+     arma::vec6 const f = g - u;
+     if (has_prev_) {
+       dG_.col(head_) = g - g_prev_;
+       dF_.col(head_) = f - f_prev_;
+       head_ = (head_ + 1) % depth_;
+       n_hist_ = std::min(n_hist_ + 1, depth_);
+     }
+     g_prev_ = g;
+     f_prev_ = f;
+     has_prev_ = true;
+     if (n_hist_ == 0) {
+       return false;
+     }
+
+     //! mixing coefficients from the (slightly regularized) normal equations; the order of
+     //! columns in the ring buffers is irrelevant
+     arma::mat const F = dF_.head_cols(n_hist_);
+     arma::mat FtF = F.t() * F;
+     FtF.diag() += 1e-10 * std::max(arma::trace(FtF), std::numeric_limits<double>::epsilon());
+     arma::vec gamma;
+     if (!arma::solve(gamma, FtF, F.t() * f, arma::solve_opts::no_approx)) {
+       return false;  // LCOV_EXCL_LINE
+     }
+     u_acc = g - dG_.head_cols(n_hist_) * gamma;
+     return u_acc.is_finite();
+   }
+
+ private:
+   size_t depth_;  //! maximum number of differences kept
+   size_t n_hist_;  //! number of differences currently kept
+   size_t head_;  //! next column to overwrite
+   bool has_prev_;  //! whether `g_prev_` and `f_prev_` are valid
+   arma::mat dG_, dF_;  //! differences of successive g(u) and f(u) (one column each)
+   arma::vec6 g_prev_, f_prev_;  //! g(u) and f(u) from the previous call
+};
+
+/**
+ * @brief Check icp inputs and configuration (printing the first problem found)
+ *
+ * @param [in] src_pts points to transform
+ * @param [in] src_covs source covariances for gicp; nullptr for other methods
+ * @param [in] target target points with cached searcher (and normals or covariances)
+ * @param [in] config icp configuration
+ * @return true if icp can run, false otherwise
+ */
+bool check_inputs(arma::mat const & src_pts, arma::cube const * src_covs,
+    transforms::ICPTarget const & target, transforms::ICPConfig const & config) noexcept {
+  arma::mat const & dst_pts = target.points();
+  arma::mat const & dst_normals = target.normals();
+  arma::cube const & dst_covs = target.covariances();
+  bool const use_planes = (config.method == transforms::icp_method_e::point_to_plane);
+  bool const use_covs = (src_covs != nullptr);
+
   // LCOV_EXCL_START
   //! input checking
   if (src_pts.n_rows != 3) {
@@ -28,75 +512,751 @@ bool transforms::iterative_closest_point(arma::mat const & src_pts, arma::mat co
     return false;
   } else if (dst_pts.n_rows != 3) {
     std::cout << static_cast<std::string>(__func__) <<
-      ": Second argument must be a matrix with 3 rows" << std::endl;
+      ": Second argument must have target points with 3 rows" << std::endl;
     return false;
-  } else if (tolerance < std::numeric_limits<double>::epsilon()) {
+  } else if (use_planes && dst_normals.n_cols != dst_pts.n_cols) {
     std::cout << static_cast<std::string>(__func__) <<
-      ": Fifth argument must be a positive scalar" << std::endl;
+      ": Second argument must have target normals for point_to_plane" << std::endl;
     return false;
-  } else if (reject_ratio < std::numeric_limits<double>::epsilon() ||
-      reject_ratio > static_cast<double>(1) - std::numeric_limits<double>::epsilon()) {
+  } else if (use_covs && (src_covs->n_slices != src_pts.n_cols ||
+        dst_covs.n_slices != dst_pts.n_cols)) {
     std::cout << static_cast<std::string>(__func__) <<
-      ": Sixth argument must be a scalar inside the interval (0, 1)" << std::endl;
+      ": Source and target covariances are required for gicp" << std::endl;
+    return false;
+  } else if (config.tolerance < std::numeric_limits<double>::epsilon()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Tolerance must be a positive scalar" << std::endl;
+    return false;
+  } else if (config.reject_ratio < std::numeric_limits<double>::epsilon() ||
+      config.reject_ratio > static_cast<double>(1) - std::numeric_limits<double>::epsilon()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Reject ratio must be a scalar inside the interval (0, 1)" << std::endl;
+    return false;
+  } else if (config.coarse_fraction < 1 && config.coarse_growth <= 1) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Coarse growth factor must be greater than 1" << std::endl;
+    return false;
+  } else if (config.nn_epsilon < 0) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Nearest-neighbor error tolerance must be nonnegative" << std::endl;
+    return false;
+  } else if (config.nn_cache_size >= transforms::NeighborCache::max_k) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Nearest-neighbor cache size must be smaller than " <<
+      transforms::NeighborCache::max_k << std::endl;
+    return false;
+  } else if (config.abort_epsilon > 0 &&
+      (config.abort_after == 0 || config.abort_heuristic_margin < 1)) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Abort bound needs at least one iteration and a margin of at least 1" << std::endl;
+    return false;
+  } else if (config.max_correspondence_distance <= 0 && config.nn_epsilon > 0 &&
+      !target.searcher_trained()) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Second argument must be built with nn_epsilon > 0 for approximate matches" << std::endl;
+    return false;
+  } else if (config.max_correspondence_distance > 0 &&
+      (target.voxels().size() != dst_pts.n_cols ||
+       target.voxels().radius() < config.max_correspondence_distance)) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Second argument must have a voxel index for max_correspondence_distance" << std::endl;
     return false;
   }
   // LCOV_EXCL_STOP
+  return true;
+}
 
-  //! transform src points by initial homogeneous transformation
-  size_t const & src_npts = src_pts.n_cols;
-  arma::mat ones(1, src_npts, arma::fill::ones);
-  arma::mat aug_src_pts = arma::join_vert(src_pts, ones);
-  arma::mat src_xform_full = H_init * aug_src_pts;
-  arma::mat src_xform = src_xform_full.rows(0, 2);
+/**
+ * @brief Iterative closest point core shared by all methods
+ *
+ * @param [in] src_pts points to transform
+ * @param [in] src_covs source covariances for gicp; nullptr for other methods
+ * @param [in][out] target target points with cached searcher (and normals or covariances)
+ * @param [in] H_init initial guess for best-fit homogeneous transformation
+ * @param [in] config icp configuration
+ * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @param [in][out] stats (optional) diagnostics
+ * @return true if converged within `config.max_its` iterations, false otherwise
+ *
+ * @note the transformed source points, index lists, and nearest-neighbor outputs are allocated
+ * once per call; iterations only compose the (rigid) transformation and update them in place
+ * @note with a coarse-to-fine schedule, the source is shuffled once (fixed seed) and only a
+ * prefix of the shuffled points is active; the prefix grows geometrically each time the relative
+ * decrease in mean error falls below `config.coarse_tolerance`, and only the full-resolution
+ * iterations are checked against `config.tolerance`
+ * @note with `config.nn_epsilon > 0`, matches are (1 + nn_epsilon)-approximate nearest neighbors;
+ * distances are exact distances to the returned matches, so error and convergence checks remain
+ * consistent with the matches used
+ * @note with Anderson acceleration, the fixed-point iteration is over u = [w; t], where w is the
+ * rotation vector of R_total*R_init.t(); an accelerated iterate is accepted only if the trimmed
+ * sum of squared distances (which plain icp never increases) does not increase
+ */
+bool run_icp(arma::mat const & src_pts, arma::cube const * src_covs,
+    transforms::ICPTarget & target, arma::mat44 const & H_init,
+    transforms::ICPConfig const & config, arma::mat44 & H_optimal,
+    transforms::ICPStats * stats) noexcept {
+  arma::mat const & dst_pts = target.points();
+  arma::mat const & dst_normals = target.normals();
+  arma::cube const & dst_covs = target.covariances();
+  bool const use_planes = (config.method == transforms::icp_method_e::point_to_plane);
+  bool const use_covs = (src_covs != nullptr);
 
-  //! identify first index to start discarding from sorted index list
-  size_t const reject_idx = std::round( (static_cast<double>(1) - reject_ratio) * src_npts );
+  if (!check_inputs(src_pts, src_covs, target, config)) {
+    return false;
+  }
 
-  //! setup nearest neighbor search
-  KDTreeSearcher dst_searcher(dst_pts);
+  //! coarse-to-fine schedule: work on a (once) shuffled copy of the source so that every level
+  //! is a prefix of the previous one; without a schedule, the source is used as-is
+  size_t const & src_npts = src_pts.n_cols;
+  size_t n_active = src_npts;
+  arma::mat src_shuffled;
+  arma::cube covs_shuffled;
+  arma::mat const * src_work = &src_pts;
+  arma::cube const * covs_work = src_covs;
+  if (config.coarse_fraction < 1) {
+    size_t const min_active = std::min(src_npts, static_cast<size_t>(10));
+    n_active = std::max(min_active,
+        static_cast<size_t>(std::ceil(config.coarse_fraction * src_npts)));
+  }
+  if (n_active < src_npts) {
+    std::vector<size_t> order(src_npts);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 gen(config.coarse_seed);
+    std::shuffle(order.begin(), order.end(), gen);
+    src_shuffled.set_size(3, src_npts);
+    for (size_t k = 0; k < src_npts; ++k) {
+      src_shuffled.col(k) = src_pts.col(order[k]);
+    }
+    src_work = &src_shuffled;
+    if (use_covs) {
+      covs_shuffled.set_size(3, 3, src_npts);
+      for (size_t k = 0; k < src_npts; ++k) {
+        covs_shuffled.slice(k) = src_covs->slice(order[k]);
+      }
+      covs_work = &covs_shuffled;
+    }
+  }
+
+  //! nearest neighbor search outputs; matches may be approximate during the iterations, so the
+  //! searcher's setting is saved here and restored before returning
+  bool const use_voxels = (config.max_correspondence_distance > 0);
+  transforms::VoxelHash const & dst_voxels = target.voxels();
+  transforms::KDTreeSearcher & dst_searcher = target.searcher();
+  transforms::ParallelSearcher const & dst_parallel = target.parallel_searcher();
+  bool const use_parallel = (!use_voxels && config.nn_epsilon == 0 &&
+      dst_parallel.size() == dst_pts.n_cols && dst_pts.n_cols > 0);
+  transforms::NeighborCache nn_cache;
+  nn_cache.k = config.nn_cache_size;
+  double const saved_epsilon = dst_searcher.Epsilon();
+  dst_searcher.Epsilon() = config.nn_epsilon;
   arma::Mat<size_t> neighbors;
   arma::mat distances;
 
+  //! workspace: allocated once, sizes are fixed for all iterations
+  arma::mat src_xform(3, src_npts);
+  std::vector<size_t> src_idx(src_npts);
+
+  //! transform (active) src points by initial transformation;
+  //! src_xform == R_total * src_work + t_total
+  arma::mat33 R_total = H_init(arma::span(0, 2), arma::span(0, 2));
+  arma::vec3 t_total = H_init(arma::span(0, 2), 3);
+  auto transform_active = [&]() {
+    src_xform.head_cols(n_active) = R_total * src_work->head_cols(n_active);
+    src_xform.head_cols(n_active).each_col() += t_total;
+  };
+  transform_active();
+
+  //! acceleration state: rotations are parameterized relative to the initial rotation
+  AndersonAccelerator anderson(config.anderson_depth);
+  arma::mat33 const R_init = R_total;
+  arma::mat33 R_plain, R_rel;
+  arma::vec3 t_plain, w;
+  arma::vec6 u, g, u_acc;
+  bool accelerated = false;
+  double energy = std::numeric_limits<double>::max();
+
   //! loop until converged
   double error = 0;
   size_t counter = 0;
-  while (counter++ < max_its) {
-    //! find nearest neighbors and distances - neighbors come from searcher
-    dst_searcher.Search(src_xform, 1, neighbors, distances);
-
-    //! throw away worst matches
-    arma::uvec const best_to_worst_idx = arma::sort_index(distances, "ascend");
-    arma::uvec const nbr_idx = arma::conv_to<arma::uvec>::from(neighbors.row(0));
-    arma::uvec const sorted_nbr_idx = nbr_idx.elem(best_to_worst_idx);
-    arma::uvec const btw_idx_src_rej = best_to_worst_idx( arma::span(0, reject_idx-1) );
-    arma::uvec const btw_idx_dst_rej = sorted_nbr_idx( arma::span(0, reject_idx-1) );
-
-    //! compute mean error and check for convergence
-    double const mean_error = arma::mean( distances.elem(btw_idx_src_rej) );
-
-    //! if converged, break out of the loop
-    if (std::abs(error - mean_error) < tolerance) {
+  size_t nn_queries = 0;
+  size_t nn_tree_searches = 0;
+  bool aborted = false;
+  bool converged = false;
+  while (counter++ < config.max_its) {
+    //! find nearest neighbors and distances of the active points - neighbors come from searcher
+    //! @note the query aliases the first `n_active` columns of src_xform (no copy)
+    arma::mat const query(src_xform.memptr(), 3, n_active, false, true);
+    size_t n_matched = n_active;
+    size_t n_searched = n_active;
+    if (use_voxels) {
+      //! unmatched points have infinite distance, so they are sorted out with the worst matches
+      n_matched = dst_voxels.search(query, neighbors, distances);
+    } else if (use_parallel && nn_cache.k > 0) {
+      //! exact matches, warm-started: points that moved little since their last kd-tree search
+      //! are matched from their cached candidates (points activated since then search the tree)
+      n_searched = dst_parallel.search(query, nn_cache, neighbors, distances);
+    } else if (use_parallel) {
+      //! exact matches, queries split across threads; same distances as the mlpack searcher
+      dst_parallel.search(query, neighbors, distances);
+    } else {
+      dst_searcher.Search(query, 1, neighbors, distances);
+    }
+    nn_queries += n_active;
+    nn_tree_searches += n_searched;
+
+    //! early abort (heuristic, not a bound): give up once the current inlier count over the
+    //! active points, scaled to the full source and by `abort_heuristic_margin`, cannot reach
+    //! the caller's target; a run that would have grown by more than the margin is lost
+    if (config.abort_epsilon > 0 && counter >= config.abort_after) {
+      size_t n_inliers = 0;
+      for (size_t k = 0; k < n_active; ++k) {
+        n_inliers += (distances(0, k) <= config.abort_epsilon);
+      }
+      double const reachable = config.abort_heuristic_margin * static_cast<double>(n_inliers) *
+        static_cast<double>(src_npts) / static_cast<double>(n_active);
+      if (reachable < static_cast<double>(config.abort_min_inliers)) {
+        aborted = true;
+        break;
+      }
+    }
+
+    //! identify first index to start discarding from (partially) sorted index list
+    size_t const reject_idx = std::min(n_matched, static_cast<size_t>(
+          std::round( (static_cast<double>(1) - config.reject_ratio) * n_active )));
+    if (use_voxels && reject_idx < 3) {
+      //! too few matches within max_correspondence_distance to determine a transformation
       break;
     }
 
-    //! reset error for next pass
-    error = mean_error;
+    //! throw away worst matches: only the best `reject_idx` are needed, not a full ordering
+    auto const idx_end = src_idx.begin() + n_active;
+    std::iota(src_idx.begin(), idx_end, 0);
+    if (reject_idx < n_active) {
+      std::nth_element(src_idx.begin(), src_idx.begin() + reject_idx, idx_end,
+          [&distances](size_t const & a, size_t const & b) {
+            return distances(0, a) < distances(0, b);
+          });
+    }
+
+    //! compute mean error of retained matches and check for convergence
+    double sum_error = 0, sum_sq_error = 0;
+    for (size_t k = 0; k < reject_idx; ++k) {
+      double const d = distances(0, src_idx[k]);
+      sum_error += d;
+      sum_sq_error += d * d;
+    }
+    double const mean_error = sum_error / static_cast<double>(reject_idx);
+
+    //! safeguard: reject an accelerated step that increased the error, fall back to the plain
+    //! step it was extrapolated from, and restart acceleration
+    if (accelerated && sum_sq_error > energy) {
+      R_total = R_plain;
+      t_total = t_plain;
+      anderson.reset();
+      accelerated = false;
+      if (stats != nullptr) {
+        ++stats->anderson_resets;
+      }
+      transform_active();
+      continue;
+    }
 
-    //! compute best transformation between the current src and nearest dst points
-    //! having rejected worst matches
-    static_cast<void>( best_fit_transform(src_xform.cols( btw_idx_src_rej ),
-          dst_pts.cols( btw_idx_dst_rej ), {}, H_optimal) );
+    //! if converged at full resolution, break out of the loop; if converged at a coarse level,
+    //! grow the active set (errors and acceleration history are not comparable across levels)
+    double const error_change = std::abs(error - mean_error);
+    if (n_active == src_npts && error_change < config.tolerance) {
+      //! `distances` are those of all source points at the transformation that is returned
+      converged = true;
+      break;
+    } else if (n_active < src_npts && error_change < config.coarse_tolerance * mean_error) {
+      n_active = std::min(src_npts,
+          static_cast<size_t>(std::ceil(config.coarse_growth * n_active)));
+      anderson.reset();
+      error = 0;
+      energy = std::numeric_limits<double>::max();
+    } else {
+      //! reset error for next pass
+      error = mean_error;
+      energy = sum_sq_error;
+    }
 
-    //! transform src points by current best transformation
-    aug_src_pts = arma::join_vert(src_xform, ones);
-    src_xform_full = H_optimal * aug_src_pts;
-    src_xform = src_xform_full.rows(0, 2);
+    //! compute best (incremental) transformation between the current src and nearest dst
+    //! points having rejected worst matches; fall back to point-to-point if the point-to-plane
+    //! or gicp problem is degenerate (e.g. all retained normals are parallel)
+    arma::mat33 R_step;
+    arma::vec3 t_step;
+    bool stepped = false;
+    if (use_covs) {
+      stepped = gicp_step(src_xform, *covs_work, dst_pts, dst_covs, R_total, neighbors, src_idx,
+          reject_idx, R_step, t_step);
+    } else if (use_planes) {
+      stepped = point_to_plane_step(src_xform, dst_pts, dst_normals, neighbors, src_idx,
+          reject_idx, R_step, t_step);
+    }
+    if (!stepped) {
+      point_to_point_step(src_xform, dst_pts, neighbors, src_idx, reject_idx, R_step, t_step);
+    }
+
+    //! compose with total transformation (plain step), then extrapolate if accelerating
+    if (anderson.enabled()) {
+      R_rel = R_total * R_init.t();
+      rotation_to_vector(R_rel, w);
+      u.head(3) = w;
+      u.tail(3) = t_total;
+    }
+    t_total = R_step * t_total + t_step;
+    R_total = R_step * R_total;
+    if (anderson.enabled()) {
+      R_plain = R_total;
+      t_plain = t_total;
+      R_rel = R_total * R_init.t();
+      rotation_to_vector(R_rel, w);
+      g.head(3) = w;
+      g.tail(3) = t_total;
+      accelerated = anderson.extrapolate(u, g, u_acc);
+      if (accelerated) {
+        w = u_acc.head(3);
+        rotation_from_vector(w, R_rel);
+        R_total = R_rel * R_init;
+        t_total = u_acc.tail(3);
+      }
+    }
+
+    //! transform (active) src points by current best transformation, in place
+    transform_active();
   }
 
-  if (counter > max_its)
-      //! algorithm didn't converge
-      return false;
+  if (stats != nullptr) {
+    stats->iterations = std::min(counter, config.max_its);
+    stats->nn_queries = nn_queries;
+    stats->nn_tree_searches = nn_tree_searches;
+    stats->aborted = aborted;
 
-  //! find best transform from source to icp transformed points
-  return best_fit_transform(src_pts, src_xform, {}, H_optimal);
+    //! inlier count at the returned transformation, from the last iteration's (exact) distances
+    bool const exact = (config.nn_epsilon == 0 &&
+        (!use_voxels || config.max_correspondence_distance >= config.inlier_epsilon));
+    stats->counted_inliers = (converged && config.inlier_epsilon > 0 && exact);
+    stats->inliers = 0;
+    if (stats->counted_inliers) {
+      for (size_t k = 0; k < src_npts; ++k) {
+        stats->inliers += (distances(0, k) <= config.inlier_epsilon);
+      }
+    }
+  }
+  dst_searcher.Epsilon() = saved_epsilon;
+
+  //! write out total transformation from source to icp transformed points
+  H_optimal.eye();
+  H_optimal(arma::span(0, 2), arma::span(0, 2)) = R_total;
+  H_optimal(arma::span(0, 2), 3) = t_total;
+
+  //! algorithm didn't converge if the iteration limit was hit (or matches ran out, or the run
+  //! was aborted)
+  return converged;
+}
+}  // namespace
+
+/**
+ * @brief Estimate unit surface normals from the covariance of nearest neighbors
+ *
+ * @param [in] pts points to estimate normals for
+ * @param [in] searcher nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in][out] normals normal at each point (columnar); sign is arbitrary
+ * @return
+ */
+void transforms::estimate_normals(arma::mat const & pts, KDTreeSearcher & searcher,
+    size_t const & k, arma::mat & normals) noexcept {
+  arma::Mat<size_t> neighbors;
+  local_neighbors(pts, searcher, k, neighbors);
+  normals_from_neighbors(pts, neighbors, normals);
+  return;
+}
+
+/**
+ * @brief Estimate unit surface normals from the covariance of nearest neighbors, with the
+ * neighbors of all points found in parallel
+ *
+ * @param [in] pts points to estimate normals for
+ * @param [in] searcher parallel nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in][out] normals normal at each point (columnar); sign is arbitrary
+ * @return
+ */
+void transforms::estimate_normals(arma::mat const & pts, ParallelSearcher const & searcher,
+    size_t const & k, arma::mat & normals) noexcept {
+  arma::Mat<size_t> neighbors;
+  local_neighbors(pts, searcher, k, neighbors);
+  normals_from_neighbors(pts, neighbors, normals);
+  return;
+}
+
+/**
+ * @brief Estimate per-point (plane-to-plane) covariances for generalized icp: the covariance of
+ * nearest neighbors with its eigenvalues replaced by (epsilon, 1, 1)
+ *
+ * @param [in] pts points to estimate covariances for
+ * @param [in] searcher nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in] epsilon variance along the surface normal
+ * @param [in][out] covs covariance at each point (one slice per point)
+ * @return
+ */
+void transforms::estimate_covariances(arma::mat const & pts, KDTreeSearcher & searcher,
+    size_t const & k, double const & epsilon, arma::cube & covs) noexcept {
+  arma::Mat<size_t> neighbors;
+  local_neighbors(pts, searcher, k, neighbors);
+  covariances_from_neighbors(pts, neighbors, epsilon, covs);
+  return;
+}
+
+/**
+ * @brief Estimate per-point (plane-to-plane) covariances for generalized icp, with the neighbors
+ * of all points found in parallel
+ *
+ * @param [in] pts points to estimate covariances for
+ * @param [in] searcher parallel nearest-neighbor searcher built on `pts`
+ * @param [in] k number of nearest neighbors (including the point itself)
+ * @param [in] epsilon variance along the surface normal
+ * @param [in][out] covs covariance at each point (one slice per point)
+ * @return
+ */
+void transforms::estimate_covariances(arma::mat const & pts, ParallelSearcher const & searcher,
+    size_t const & k, double const & epsilon, arma::cube & covs) noexcept {
+  arma::Mat<size_t> neighbors;
+  local_neighbors(pts, searcher, k, neighbors);
+  covariances_from_neighbors(pts, neighbors, epsilon, covs);
+  return;
+}
+
+/**
+ * @brief Iterative closest point algorithm: Perform point-set alignment on two sets of points with outlier rejection.
+ *
+ * @param [in] src_pts points to transform
+ * @param [in] dst_pts target points
+ * @param [in] H_init initial guess for best-fit homogeneous transformation
+ * @param [in] max_its maximum number of iterations
+ * @param [in] tolerance criteria for convergence, in terms of mean error between iterations
+ * @param [in] reject_ratio ratio of worst-matches to reject in fit
+ * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @return
+ *
+ * @note builds an `ICPTarget` for `dst_pts` and runs point-to-point icp; prefer the `ICPTarget`
+ * overload when aligning several sources to the same target
+ */
+bool transforms::iterative_closest_point(arma::mat const & src_pts, arma::mat const & dst_pts,
+    arma::mat44 & H_init, size_t const & max_its, double const & tolerance,
+    double const & reject_ratio, arma::mat44 & H_optimal) noexcept {
+  // LCOV_EXCL_START
+  //! input checking
+  if (dst_pts.n_rows != 3) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Second argument must be a matrix with 3 rows" << std::endl;
+    return false;
+  }
+  // LCOV_EXCL_STOP
+
+  ICPConfig config;
+  config.max_its = max_its;
+  config.tolerance = tolerance;
+  config.reject_ratio = reject_ratio;
+  config.method = icp_method_e::point_to_point;
+  ICPTarget target(dst_pts, config);
+  return iterative_closest_point(src_pts, target, H_init, config, H_optimal);
+}
+
+/**
+ * @brief Iterative closest point algorithm against a prebuilt target
+ *
+ * @param [in] src_pts points to transform
+ * @param [in][out] target target points with cached searcher (and normals); see `ICPTarget`
+ * @param [in] H_init initial guess for best-fit homogeneous transformation
+ * @param [in] config icp configuration; see `ICPConfig`
+ * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @param [in][out] stats (optional) diagnostics; see `ICPStats`
+ * @return true if converged within `config.max_its` iterations, false otherwise
+ */
+bool transforms::iterative_closest_point(arma::mat const & src_pts, ICPTarget & target,
+    arma::mat44 const & H_init, ICPConfig const & config, arma::mat44 & H_optimal,
+    ICPStats * stats) noexcept {
+  if (config.method == icp_method_e::gicp) {
+    ParallelSearcher const src_searcher(src_pts);
+    arma::cube src_covs;
+    estimate_covariances(src_pts, src_searcher, config.normal_neighbors,
+        config.covariance_epsilon, src_covs);
+    return generalized_icp(src_pts, src_covs, target, H_init, config, H_optimal, stats);
+  }
+  return run_icp(src_pts, nullptr, target, H_init, config, H_optimal, stats);
+}
+
+/**
+ * @brief Generalized icp (plane-to-plane) against a prebuilt target with precomputed source
+ * covariances
+ *
+ * @param [in] src_pts points to transform
+ * @param [in] src_covs source covariances; see `estimate_covariances`
+ * @param [in][out] target target points with cached searcher and covariances; see `ICPTarget`
+ * @param [in] H_init initial guess for best-fit homogeneous transformation
+ * @param [in] config icp configuration; see `ICPConfig` (`method` is ignored)
+ * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @param [in][out] stats (optional) diagnostics; see `ICPStats`
+ * @return true if converged within `config.max_its` iterations, false otherwise
+ */
+bool transforms::generalized_icp(arma::mat const & src_pts, arma::cube const & src_covs,
+    ICPTarget & target, arma::mat44 const & H_init, ICPConfig const & config,
+    arma::mat44 & H_optimal, ICPStats * stats) noexcept {
+  return run_icp(src_pts, &src_covs, target, H_init, config, H_optimal, stats);
+}
+
+/**
+ * @brief Iterative closest point for several initial transformations (hypotheses) of the same
+ * source against a prebuilt target, refined in lock step
+ *
+ * @param [in] src_pts points to transform
+ * @param [in][out] target target points with cached searcher (and normals); see `ICPTarget`
+ * @param [in] H_init initial guesses for best-fit homogeneous transformations (one slice each)
+ * @param [in] config icp configuration; see `ICPConfig`
+ * @param [in][out] H_optimal best-fit transformation of each hypothesis (one slice each)
+ * @param [in][out] converged 1 for each hypothesis that converged within `config.max_its`
+ * iterations, 0 otherwise
+ * @param [in][out] stats (optional) diagnostics of each hypothesis; see `ICPStats`
+ * @return number of hypotheses that converged
+ *
+ * @note each hypothesis follows `iterative_closest_point` (same trimming, convergence test, early
+ * abort, and inlier count), so results agree up to rounding; hypotheses leave the batch as they
+ * converge, are aborted, or run out of iterations
+ * @note per iteration, the queries of all remaining hypotheses form one batch: the source is put
+ * in Morton order once, and the batch interleaves hypotheses point by point, so consecutive
+ * queries are close in space (always within a hypothesis; across hypotheses once they agree) and
+ * reuse the same kd-tree nodes and target points
+ * @note lock step needs the target's parallel searcher and exact point_to_point or point_to_plane
+ * matching without Anderson acceleration or a coarse-to-fine schedule; other configurations run
+ * the hypotheses one after another
+ */
+size_t transforms::iterative_closest_points(arma::mat const & src_pts, ICPTarget & target,
+    arma::cube const & H_init, ICPConfig const & config, arma::cube & H_optimal,
+    arma::uvec & converged, std::vector<ICPStats> * stats) noexcept {
+  size_t const n_hyp = H_init.n_slices;
+  H_optimal.set_size(4, 4, n_hyp);
+  converged.zeros(n_hyp);
+  if (stats != nullptr) {
+    stats->assign(n_hyp, ICPStats());
+  }
+
+  // LCOV_EXCL_START
+  //! input checking
+  if (H_init.n_rows != 4 || H_init.n_cols != 4) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Third argument must be a cube of 4x4 slices" << std::endl;
+    return 0;
+  }
+  // LCOV_EXCL_STOP
+
+  arma::mat const & dst_pts = target.points();
+  arma::mat const & dst_normals = target.normals();
+  ParallelSearcher const & dst_parallel = target.parallel_searcher();
+  bool const use_planes = (config.method == icp_method_e::point_to_plane);
+  size_t const & n = src_pts.n_cols;
+  bool const lock_step = (config.method != icp_method_e::gicp && config.anderson_depth == 0 &&
+      config.coarse_fraction >= 1 && config.nn_epsilon == 0 &&
+      config.max_correspondence_distance <= 0 && dst_parallel.size() == dst_pts.n_cols &&
+      dst_pts.n_cols > 0 && n > 0);
+  if (!lock_step) {
+    size_t n_converged = 0;
+    for (size_t h = 0; h < n_hyp; ++h) {
+      arma::mat44 const H_h = H_init.slice(h);
+      arma::mat44 H_opt;
+      converged(h) = iterative_closest_point(src_pts, target, H_h, config, H_opt,
+          (stats != nullptr) ? &(*stats)[h] : nullptr);
+      H_optimal.slice(h) = H_opt;
+      n_converged += converged(h);
+    }
+    return n_converged;
+  }
+  if (!check_inputs(src_pts, nullptr, target, config)) {
+    return 0;
+  }
+
+  //! source in Morton order: points that are close in space stay close under any rigid
+  //! transformation, so each hypothesis' queries are spatially coherent in this order
+  std::vector<size_t> order;
+  morton_order(src_pts, order);
+  arma::mat src_sorted(3, n);
+  for (size_t i = 0; i < n; ++i) {
+    src_sorted.col(i) = src_pts.col(order[i]);
+  }
+
+  //! per-hypothesis state and workspace; `active` lists the hypotheses still in the batch
+  size_t const reject_idx = static_cast<size_t>(
+      std::round( (static_cast<double>(1) - config.reject_ratio) * n ));
+  std::vector<arma::mat33> R_total(n_hyp);
+  std::vector<arma::vec3> t_total(n_hyp);
+  std::vector<double> error(n_hyp, 0);
+  std::vector<size_t> counter(n_hyp, 0), nn_tree_searches(n_hyp, 0);
+  std::vector<uint8_t> aborted(n_hyp, 0), finished(n_hyp, 0);
+  std::vector<arma::Mat<size_t>> neighbors(n_hyp, arma::Mat<size_t>(1, n));
+  std::vector<arma::mat> distances(n_hyp, arma::mat(1, n));
+  std::vector<std::vector<size_t>> src_idx(n_hyp, std::vector<size_t>(n));
+  std::vector<arma::mat> src_xform(n_hyp);
+  std::vector<size_t> active(n_hyp);
+  std::iota(active.begin(), active.end(), 0);
+  for (size_t h = 0; h < n_hyp; ++h) {
+    R_total[h] = H_init.slice(h)(arma::span(0, 2), arma::span(0, 2));
+    t_total[h] = H_init.slice(h)(arma::span(0, 2), 3);
+    src_xform[h] = R_total[h] * src_sorted;
+    src_xform[h].each_col() += t_total[h];
+  }
+
+  //! batch: column i * (no. of active hypotheses) + s is point i of hypothesis active[s]
+  arma::mat batch;
+  arma::Mat<size_t> batch_neighbors;
+  arma::mat batch_distances;
+  NeighborCache nn_cache;
+  nn_cache.k = config.nn_cache_size;
+  while (!active.empty()) {
+    //! hypotheses that converged, were aborted, or ran out of iterations leave the batch
+    std::vector<size_t> next;
+    for (size_t const & h : active) {
+      if (!finished[h] && counter[h]++ < config.max_its) {
+        next.push_back(h);
+      }
+    }
+    if (next.size() != active.size()) {
+      //! keep the warm-start cache aligned with the new batch layout
+      if (nn_cache.k > 0 && nn_cache.anchors.n_cols == n * active.size()) {
+        NeighborCache compact;
+        compact.k = nn_cache.k;
+        compact.anchors.set_size(3, n * next.size());
+        compact.candidates.set_size(nn_cache.k, n * next.size());
+        compact.radii.set_size(n * next.size());
+        for (size_t s_new = 0, s_old = 0; s_new < next.size(); ++s_new) {
+          while (active[s_old] != next[s_new]) {
+            ++s_old;
+          }
+          for (size_t i = 0; i < n; ++i) {
+            size_t const c_old = i * active.size() + s_old;
+            size_t const c_new = i * next.size() + s_new;
+            compact.anchors.col(c_new) = nn_cache.anchors.col(c_old);
+            compact.candidates.col(c_new) = nn_cache.candidates.col(c_old);
+            compact.radii(c_new) = nn_cache.radii(c_old);
+          }
+        }
+        nn_cache = std::move(compact);
+      }
+      active.swap(next);
+      if (active.empty()) {
+        break;
+      }
+    }
+    size_t const n_act = active.size();
+
+    //! gather, search all queries of the batch at once, scatter
+    batch.set_size(3, n * n_act);
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+      for (size_t s = 0; s < n_act; ++s) {
+        double const * p = src_xform[active[s]].colptr(i);
+        std::copy(p, p + 3, batch.colptr(i * n_act + s));
+      }
+    }
+    if (nn_cache.k > 0) {
+      dst_parallel.search(batch, nn_cache, batch_neighbors, batch_distances);
+    } else {
+      dst_parallel.search(batch, batch_neighbors, batch_distances);
+    }
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0; i < static_cast<int64_t>(n); ++i) {
+      for (size_t s = 0; s < n_act; ++s) {
+        size_t const c = i * n_act + s;
+        neighbors[active[s]](0, i) = batch_neighbors(0, c);
+        distances[active[s]](0, i) = batch_distances(0, c);
+      }
+    }
+    for (size_t s = 0; s < n_act; ++s) {
+      size_t n_searched = n;
+      if (nn_cache.k > 0) {
+        n_searched = 0;
+        for (size_t i = 0; i < n; ++i) {
+          n_searched += nn_cache.searched[i * n_act + s];
+        }
+      }
+      nn_tree_searches[active[s]] += n_searched;
+    }
+
+    //! per-hypothesis iteration (as in `iterative_closest_point`): early abort, trimming,
+    //! convergence test, and incremental transformation
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t s = 0; s < static_cast<int64_t>(n_act); ++s) {
+      size_t const h = active[s];
+      arma::mat const & dists = distances[h];
+      if (config.abort_epsilon > 0 && counter[h] >= config.abort_after) {
+        size_t n_inliers = 0;
+        for (size_t k = 0; k < n; ++k) {
+          n_inliers += (dists(0, k) <= config.abort_epsilon);
+        }
+        if (config.abort_heuristic_margin * static_cast<double>(n_inliers) <
+            static_cast<double>(config.abort_min_inliers)) {
+          aborted[h] = 1;
+          finished[h] = 1;
+          continue;
+        }
+      }
+
+      std::vector<size_t> & idx = src_idx[h];
+      std::iota(idx.begin(), idx.end(), 0);
+      if (reject_idx < n) {
+        std::nth_element(idx.begin(), idx.begin() + reject_idx, idx.end(),
+            [&dists](size_t const & a, size_t const & b) {
+              return dists(0, a) < dists(0, b);
+            });
+      }
+      double sum_error = 0;
+      for (size_t k = 0; k < reject_idx; ++k) {
+        sum_error += dists(0, idx[k]);
+      }
+      double const mean_error = sum_error / static_cast<double>(reject_idx);
+      if (std::abs(error[h] - mean_error) < config.tolerance) {
+        converged(h) = 1;
+        finished[h] = 1;
+        continue;
+      }
+      error[h] = mean_error;
+
+      arma::mat & xform = src_xform[h];
+      arma::mat33 R_step;
+      arma::vec3 t_step;
+      if (!use_planes || !point_to_plane_step(xform, dst_pts, dst_normals, neighbors[h], idx,
+            reject_idx, R_step, t_step)) {
+        point_to_point_step(xform, dst_pts, neighbors[h], idx, reject_idx, R_step, t_step);
+      }
+      t_total[h] = R_step * t_total[h] + t_step;
+      R_total[h] = R_step * R_total[h];
+      xform = R_total[h] * src_sorted;
+      xform.each_col() += t_total[h];
+    }
+  }
+
+  //! write out results
+  size_t n_converged = 0;
+  for (size_t h = 0; h < n_hyp; ++h) {
+    H_optimal.slice(h).eye();
+    H_optimal.slice(h)(arma::span(0, 2), arma::span(0, 2)) = R_total[h];
+    H_optimal.slice(h)(arma::span(0, 2), 3) = t_total[h];
+    n_converged += converged(h);
+    if (stats != nullptr) {
+      ICPStats & st = (*stats)[h];
+      st.iterations = std::min(counter[h], config.max_its);
+      st.nn_queries = st.iterations * n;
+      st.nn_tree_searches = nn_tree_searches[h];
+      st.aborted = (aborted[h] != 0);
+      st.counted_inliers = (converged(h) != 0 && config.inlier_epsilon > 0);
+      st.inliers = 0;
+      if (st.counted_inliers) {
+        for (size_t k = 0; k < n; ++k) {
+          st.inliers += (distances[h](0, k) <= config.inlier_epsilon);
+        }
+      }
+    }
+  }
+  return n_converged;
 }
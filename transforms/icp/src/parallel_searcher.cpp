@@ -0,0 +1,517 @@
+//! c/c++ headers
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+//! dependency headers
+//! project headers
+#include "transforms/icp/parallel_searcher.hpp"
+
+namespace {
+//! subtrees with at least this many points are built as separate tasks
+constexpr size_t min_task_points = 4096;
+
+//! leaf points whose distances are computed together (in SIMD lanes) before any insertion
+constexpr size_t leaf_chunk = 32;
+
+/**
+ * @brief Squared distance from a point to an axis-aligned box
+ *
+ * @param [in] lo lower corner of the box (3 values)
+ * @param [in] hi upper corner of the box (3 values)
+ * @param [in] q pointer to point (3 contiguous values)
+ * @return squared distance (0 if the point is inside the box)
+ */
+inline double box_distance_sq(double const * lo, double const * hi, double const * q) noexcept {
+  double d_sq = 0;
+  for (size_t r = 0; r < 3; ++r) {
+    double const gap = std::max({lo[r] - q[r], q[r] - hi[r], 0.});
+    d_sq += gap * gap;
+  }
+  return d_sq;
+}
+
+/**
+ * @brief Number of nodes in a kd-tree over `count` points that splits at the median
+ *
+ * @param [in] count number of points
+ * @param [in] leaf_size maximum number of points in a leaf
+ * @return number of nodes (1 for a leaf)
+ */
+size_t subtree_nodes(size_t const & count, size_t const & leaf_size) noexcept {
+  if (count <= leaf_size) {
+    return 1;
+  }
+  size_t const n_left = count / 2;
+  size_t const left = subtree_nodes(n_left, leaf_size);
+  //! both halves have the same size for an even count
+  size_t const right = (count - n_left == n_left) ? left :
+    subtree_nodes(count - n_left, leaf_size);
+  return 1 + left + right;
+}
+
+/**
+ * @brief Insert a candidate into a list of the best matches so far, kept sorted by distance
+ *
+ * @param [in] i column of candidate in the tree's dataset
+ * @param [in] d_sq squared distance to candidate
+ * @param [in] m capacity of the list
+ * @param [in][out] idx columns of best matches so far
+ * @param [in][out] best_d_sq squared distances to best matches so far (ascending)
+ * @param [in][out] found number of matches in the list
+ * @return
+ *
+ * @note a candidate goes after matches at the same distance, so ties go to the first point reached
+ */
+inline void insert(size_t const & i, double const & d_sq, size_t const & m, size_t * idx,
+    double * best_d_sq, size_t & found) noexcept {
+  size_t k = (found < m) ? found++ : m - 1;
+  while (k > 0 && best_d_sq[k - 1] > d_sq) {
+    best_d_sq[k] = best_d_sq[k - 1];
+    idx[k] = idx[k - 1];
+    --k;
+  }
+  best_d_sq[k] = d_sq;
+  idx[k] = i;
+  return;
+}
+}  // namespace
+
+/** ParallelSearcher::ParallelSearcher(pts, leaf_size)
+ * @brief constructor; builds the kd-tree (in parallel)
+ *
+ * @param[in] pts reference points (columnar, 3 rows)
+ * @param[in] leaf_size maximum number of points in a leaf
+ * @return
+ */
+transforms::ParallelSearcher::ParallelSearcher(arma::mat const & pts,
+    size_t const & leaf_size) noexcept {
+  // LCOV_EXCL_START
+  //! input checking
+  if (pts.n_rows != 3) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": First argument must be a matrix with 3 rows" << std::endl;
+    return;
+  } else if (leaf_size == 0) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Second argument must be a positive integer" << std::endl;
+    return;
+  }
+  // LCOV_EXCL_STOP
+  if (pts.n_cols == 0) {
+    return;
+  }
+  size_t const n_pts = pts.n_cols;
+
+  //! the shape of the tree is known up front, so every subtree owns a fixed range of slots
+  nodes_.resize(subtree_nodes(n_pts, leaf_size));
+  old_from_new_.resize(n_pts);
+  std::iota(old_from_new_.begin(), old_from_new_.end(), static_cast<size_t>(0));
+  #pragma omp parallel
+  {
+    #pragma omp single
+    build(pts, old_from_new_, 0, 0, n_pts, leaf_size);
+  }
+
+  //! copy the points into leaf order
+  points_.resize(n_pts);
+  double * xs = points_.x();
+  double * ys = points_.y();
+  double * zs = points_.z();
+  int64_t const n = static_cast<int64_t>(n_pts);
+  #pragma omp parallel for schedule(static)
+  for (int64_t i = 0; i < n; ++i) {
+    double const * p = pts.colptr(old_from_new_[i]);
+    xs[i] = p[0];
+    ys[i] = p[1];
+    zs[i] = p[2];
+  }
+}
+
+/** ParallelSearcher::build(pts, order, slot, begin, count, leaf_size)
+ * @brief build the subtree over columns [begin, begin + count) of `order` into the slots
+ * starting at `slot`, spawning a task for large subtrees
+ *
+ * @param[in] pts reference points (columnar, 3 rows)
+ * @param[in][out] order column of `pts` at each position; rearranged so that every subtree is
+ * a contiguous range
+ * @param[in] slot array slot of the subtree's root
+ * @param[in] begin first position of the subtree's points in `order`
+ * @param[in] count number of points in the subtree
+ * @param[in] leaf_size maximum number of points in a leaf
+ * @return
+ */
+void transforms::ParallelSearcher::build(arma::mat const & pts, std::vector<size_t> & order,
+    size_t const & slot, size_t const & begin, size_t const & count,
+    size_t const & leaf_size) noexcept {
+  Node & node = nodes_[slot];
+  node.begin = begin;
+  node.count = count;
+  node.right = 0;
+
+  //! tight bounding box
+  std::fill(node.lo, node.lo + 3, std::numeric_limits<double>::infinity());
+  std::fill(node.hi, node.hi + 3, -std::numeric_limits<double>::infinity());
+  for (size_t i = begin; i < begin + count; ++i) {
+    double const * p = pts.colptr(order[i]);
+    for (size_t r = 0; r < 3; ++r) {
+      node.lo[r] = std::min(node.lo[r], p[r]);
+      node.hi[r] = std::max(node.hi[r], p[r]);
+    }
+  }
+  if (count <= leaf_size) {
+    return;
+  }
+
+  //! split at the median of the widest dimension
+  size_t dim = 0;
+  for (size_t r = 1; r < 3; ++r) {
+    if (node.hi[r] - node.lo[r] > node.hi[dim] - node.lo[dim]) {
+      dim = r;
+    }
+  }
+  size_t const n_left = count / 2;
+  auto const first = order.begin() + static_cast<std::ptrdiff_t>(begin);
+  std::nth_element(first, first + static_cast<std::ptrdiff_t>(n_left),
+      first + static_cast<std::ptrdiff_t>(count),
+      [&pts, &dim](size_t const & a, size_t const & b) { return pts(dim, a) < pts(dim, b); });
+  node.right = slot + 1 + subtree_nodes(n_left, leaf_size);
+
+  //! the halves write disjoint slots and disjoint ranges of `order`
+  size_t const right = node.right;
+  if (count >= min_task_points) {
+    #pragma omp task shared(pts, order)
+    build(pts, order, slot + 1, begin, n_left, leaf_size);
+  } else {
+    build(pts, order, slot + 1, begin, n_left, leaf_size);
+  }
+  build(pts, order, right, begin + n_left, count - n_left, leaf_size);
+  return;
+}
+
+/** ParallelSearcher::descend(slot, node_d_sq, query, m, indices, distances_sq, found)
+ * @brief depth-first m-nearest-neighbor descent: nearer child first, prune by box distance
+ *
+ * @param[in] slot array slot of the node
+ * @param[in] node_d_sq squared distance from the query to the node's bounding box
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in] m number of neighbors to find
+ * @param[in][out] indices columns of best matches so far in the tree's dataset
+ * @param[in][out] distances_sq squared distances to best matches so far (ascending)
+ * @param[in][out] found number of best matches so far
+ * @return
+ */
+void transforms::ParallelSearcher::descend(size_t const & slot, double const & node_d_sq,
+    double const * query, size_t const & m, size_t * indices, double * distances_sq,
+    size_t & found) const noexcept {
+  if (found == m && node_d_sq >= distances_sq[m - 1]) {
+    return;
+  }
+  Node const & node = nodes_[slot];
+  if (node.right == 0) {
+    //! distances to a chunk of the leaf from contiguous x, y and z values, then the insertions
+    double const * xs = points_.x();
+    double const * ys = points_.y();
+    double const * zs = points_.z();
+    double chunk_d_sq[leaf_chunk];
+    size_t const end = node.begin + node.count;
+    for (size_t first = node.begin; first < end; first += leaf_chunk) {
+      size_t const n_chunk = std::min(leaf_chunk, end - first);
+      #pragma omp simd
+      for (size_t j = 0; j < n_chunk; ++j) {
+        double const dx = xs[first + j] - query[0];
+        double const dy = ys[first + j] - query[1];
+        double const dz = zs[first + j] - query[2];
+        chunk_d_sq[j] = dx * dx + dy * dy + dz * dz;
+      }
+      for (size_t j = 0; j < n_chunk; ++j) {
+        if (found < m || chunk_d_sq[j] < distances_sq[m - 1]) {
+          insert(first + j, chunk_d_sq[j], m, indices, distances_sq, found);
+        }
+      }
+    }
+    return;
+  }
+  size_t const left = slot + 1;
+  size_t const right = node.right;
+  double const left_d_sq = box_distance_sq(nodes_[left].lo, nodes_[left].hi, query);
+  double const right_d_sq = box_distance_sq(nodes_[right].lo, nodes_[right].hi, query);
+  if (left_d_sq <= right_d_sq) {
+    descend(left, left_d_sq, query, m, indices, distances_sq, found);
+    descend(right, right_d_sq, query, m, indices, distances_sq, found);
+  } else {
+    descend(right, right_d_sq, query, m, indices, distances_sq, found);
+    descend(left, left_d_sq, query, m, indices, distances_sq, found);
+  }
+  return;
+}
+
+/** ParallelSearcher::nearest(query, index, distance)
+ * @brief find the nearest reference point of a query point
+ *
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in][out] index column of nearest point in the `pts` used to build the searcher
+ * @param[in][out] distance distance to nearest point
+ * @return true if there is a reference point, false otherwise (outputs untouched)
+ */
+bool transforms::ParallelSearcher::nearest(double const * query, size_t & index,
+    double & distance) const noexcept {
+  if (nodes_.empty()) {
+    return false;
+  }
+  size_t best;
+  double best_d_sq;
+  // LCOV_EXCL_START
+  if (nearest(query, 1, &best, &best_d_sq) == 0) {
+    //! only possible for non-finite queries
+    return false;
+  }
+  // LCOV_EXCL_STOP
+  index = best;
+  distance = std::sqrt(best_d_sq);
+  return true;
+}
+
+/** ParallelSearcher::nearest(query, m, indices, distances_sq)
+ * @brief find the m nearest reference points of a query point
+ *
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in] m number of neighbors to find
+ * @param[in][out] indices columns of nearest points in the `pts` used to build the searcher,
+ * nearest first (room for m values)
+ * @param[in][out] distances_sq squared distances to nearest points, ascending (room for m
+ * values)
+ * @return number of neighbors found (min(m, size()) for finite queries)
+ */
+size_t transforms::ParallelSearcher::nearest(double const * query, size_t const & m,
+    size_t * indices, double * distances_sq) const noexcept {
+  size_t const found = nearest_in_tree(query, m, indices, distances_sq);
+  for (size_t k = 0; k < found; ++k) {
+    indices[k] = old_from_new_[indices[k]];
+  }
+  return found;
+}
+
+/** ParallelSearcher::nearest_in_tree(query, m, indices, distances_sq)
+ * @brief find the m nearest reference points of a query point, as columns of the kd-tree's
+ * (rearranged) dataset
+ *
+ * @param[in] query pointer to query point (3 contiguous values)
+ * @param[in] m number of neighbors to find
+ * @param[in][out] indices columns of nearest points in the tree's dataset, nearest first
+ * @param[in][out] distances_sq squared distances to nearest points, ascending
+ * @return number of neighbors found
+ */
+size_t transforms::ParallelSearcher::nearest_in_tree(double const * query, size_t const & m,
+    size_t * indices, double * distances_sq) const noexcept {
+  if (nodes_.empty() || m == 0) {
+    return 0;
+  }
+  double const root_d_sq = box_distance_sq(nodes_[0].lo, nodes_[0].hi, query);
+  if (!std::isfinite(root_d_sq)) {
+    return 0;
+  }
+  size_t found = 0;
+  descend(0, root_d_sq, query, m, indices, distances_sq, found);
+  return found;
+}
+
+/** ParallelSearcher::search(queries, neighbors, distances, block_size)
+ * @brief batched nearest-neighbor search, with the same output layout as
+ * `KDTreeSearcher::Search` for k = 1
+ *
+ * @param[in] queries query points (columnar, 3 rows)
+ * @param[in][out] neighbors nearest reference point for each query (1 x no. of queries);
+ * reallocated only if its size differs
+ * @param[in][out] distances distance to nearest reference point (1 x no. of queries);
+ * reallocated only if its size differs
+ * @param[in] block_size no. of queries handed to a thread at a time
+ * @return
+ */
+void transforms::ParallelSearcher::search(arma::mat const & queries,
+    arma::Mat<size_t> & neighbors, arma::mat & distances,
+    size_t const & block_size) const noexcept {
+  if (neighbors.n_rows != 1 || neighbors.n_cols != queries.n_cols) {
+    neighbors.set_size(1, queries.n_cols);
+  }
+  if (distances.n_rows != 1 || distances.n_cols != queries.n_cols) {
+    distances.set_size(1, queries.n_cols);
+  }
+  int64_t const n = static_cast<int64_t>(queries.n_cols);
+  int64_t const block = static_cast<int64_t>(std::max(block_size, static_cast<size_t>(1)));
+  int64_t const n_blocks = (n + block - 1) / block;
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (int64_t b = 0; b < n_blocks; ++b) {
+    for (int64_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+      if (!nearest(queries.colptr(i), neighbors(0, i), distances(0, i))) {
+        neighbors(0, i) = size();
+        distances(0, i) = std::numeric_limits<double>::infinity();
+      }
+    }
+  }
+  return;
+}
+
+/** ParallelSearcher::search(queries, k, neighbors, distances, block_size)
+ * @brief batched k-nearest-neighbor search, with the same output layout as
+ * `KDTreeSearcher::Search`
+ *
+ * @param[in] queries query points (columnar, 3 rows)
+ * @param[in] k number of neighbors to find for each query
+ * @param[in][out] neighbors nearest reference points for each query, nearest first
+ * (k x no. of queries); missing neighbors are `size()`
+ * @param[in][out] distances distances to nearest reference points, ascending
+ * (k x no. of queries); missing neighbors are infinitely far away
+ * @param[in] block_size no. of queries handed to a thread at a time
+ * @return
+ */
+void transforms::ParallelSearcher::search(arma::mat const & queries, size_t const & k,
+    arma::Mat<size_t> & neighbors, arma::mat & distances,
+    size_t const & block_size) const noexcept {
+  if (neighbors.n_rows != k || neighbors.n_cols != queries.n_cols) {
+    neighbors.set_size(k, queries.n_cols);
+  }
+  if (distances.n_rows != k || distances.n_cols != queries.n_cols) {
+    distances.set_size(k, queries.n_cols);
+  }
+  if (k == 0) {
+    return;
+  }
+  int64_t const n = static_cast<int64_t>(queries.n_cols);
+  int64_t const block = static_cast<int64_t>(std::max(block_size, static_cast<size_t>(1)));
+  int64_t const n_blocks = (n + block - 1) / block;
+  #pragma omp parallel for schedule(dynamic, 1)
+  for (int64_t b = 0; b < n_blocks; ++b) {
+    for (int64_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+      size_t * idx = neighbors.colptr(i);
+      double * d = distances.colptr(i);
+      size_t const found = nearest(queries.colptr(i), k, idx, d);
+      for (size_t j = 0; j < found; ++j) {
+        d[j] = std::sqrt(d[j]);
+      }
+      std::fill(idx + found, idx + k, size());
+      std::fill(d + found, d + k, std::numeric_limits<double>::infinity());
+    }
+  }
+  return;
+}
+
+/** ParallelSearcher::search(queries, cache, neighbors, distances, block_size)
+ * @brief batched nearest-neighbor search, warm-started from the neighbors found for the same
+ * queries at earlier positions
+ *
+ * @param[in] queries query points (columnar, 3 rows); column i is the (moved) query i of the
+ * previous call with the same cache
+ * @param[in][out] cache candidate neighbors of each query; see `NeighborCache`
+ * @param[in][out] neighbors nearest reference point for each query (1 x no. of queries);
+ * reallocated only if its size differs
+ * @param[in][out] distances distance to nearest reference point (1 x no. of queries);
+ * reallocated only if its size differs
+ * @param[in] block_size no. of queries handed to a thread at a time
+ * @return number of queries that needed a search of the kd-tree
+ *
+ * @note at its last kd-tree search, query i was at `cache.anchors.col(i)` and the k cached
+ * candidates were its k nearest neighbors, with every other reference point at least
+ * `cache.radii(i)` away.  By the triangle inequality, after moving by delta, every other point is
+ * at least `radii(i) - delta` away, so the best candidate is the nearest neighbor if it is no
+ * farther than that; otherwise the query searches the kd-tree and the cache is refreshed
+ * @note results are exact and, like the plain search, independent of threads and block size
+ */
+size_t transforms::ParallelSearcher::search(arma::mat const & queries, NeighborCache & cache,
+    arma::Mat<size_t> & neighbors, arma::mat & distances,
+    size_t const & block_size) const noexcept {
+  size_t const & k = cache.k;
+  // LCOV_EXCL_START
+  //! input checking
+  if (k == 0 || k >= NeighborCache::max_k) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Cache size must be in [1, " << NeighborCache::max_k << ")" << std::endl;
+    search(queries, neighbors, distances, block_size);
+    return queries.n_cols;
+  }
+  // LCOV_EXCL_STOP
+
+  //! columns added since the last call (or all, if the cache is new or was built for a different
+  //! k) start with an invalid cache entry
+  size_t n_valid = std::min(cache.anchors.n_cols, static_cast<size_t>(queries.n_cols));
+  if (cache.candidates.n_rows != k) {
+    n_valid = 0;
+  }
+  if (cache.anchors.n_cols != queries.n_cols || cache.candidates.n_rows != k) {
+    cache.anchors.resize(3, queries.n_cols);
+    cache.candidates.resize(k, queries.n_cols);
+    cache.radii.resize(queries.n_cols);
+  }
+  if (n_valid < queries.n_cols) {
+    cache.radii.tail(queries.n_cols - n_valid).fill(-1);
+  }
+  cache.searched.resize(queries.n_cols);
+
+  if (neighbors.n_rows != 1 || neighbors.n_cols != queries.n_cols) {
+    neighbors.set_size(1, queries.n_cols);
+  }
+  if (distances.n_rows != 1 || distances.n_cols != queries.n_cols) {
+    distances.set_size(1, queries.n_cols);
+  }
+  int64_t const n = static_cast<int64_t>(queries.n_cols);
+  int64_t const block = static_cast<int64_t>(std::max(block_size, static_cast<size_t>(1)));
+  int64_t const n_blocks = (n + block - 1) / block;
+  size_t n_searched = 0;
+  #pragma omp parallel for schedule(dynamic, 1) reduction(+:n_searched)
+  for (int64_t b = 0; b < n_blocks; ++b) {
+    size_t idx[NeighborCache::max_k];
+    double d_sq[NeighborCache::max_k];
+    for (int64_t i = b * block; i < std::min(n, (b + 1) * block); ++i) {
+      double const * q = queries.colptr(i);
+
+      //! local re-search: best cached candidate, accepted if no other point can be closer
+      double const * a = cache.anchors.colptr(i);
+      double const delta = std::sqrt((q[0] - a[0]) * (q[0] - a[0]) +
+          (q[1] - a[1]) * (q[1] - a[1]) + (q[2] - a[2]) * (q[2] - a[2]));
+      if (cache.radii(i) >= delta) {
+        size_t const * cands = cache.candidates.colptr(i);
+        size_t best = cands[0];
+        double best_d_sq = std::numeric_limits<double>::infinity();
+        for (size_t j = 0; j < k && cands[j] < size(); ++j) {
+          double const dx = points_.x()[cands[j]] - q[0];
+          double const dy = points_.y()[cands[j]] - q[1];
+          double const dz = points_.z()[cands[j]] - q[2];
+          double const c_d_sq = dx * dx + dy * dy + dz * dz;
+          if (c_d_sq < best_d_sq) {
+            best_d_sq = c_d_sq;
+            best = cands[j];
+          }
+        }
+        double const bound = cache.radii(i) - delta;
+        if (best_d_sq <= bound * bound) {
+          neighbors(0, i) = old_from_new_[best];
+          distances(0, i) = std::sqrt(best_d_sq);
+          cache.searched[i] = 0;
+          continue;
+        }
+      }
+
+      //! fall back to the kd-tree: k + 1 neighbors refresh the candidates and the radius
+      ++n_searched;
+      cache.searched[i] = 1;
+      size_t const found = nearest_in_tree(q, k + 1, idx, d_sq);
+      if (found == 0) {
+        neighbors(0, i) = size();
+        distances(0, i) = std::numeric_limits<double>::infinity();
+        cache.radii(i) = -1;
+        continue;
+      }
+      neighbors(0, i) = old_from_new_[idx[0]];
+      distances(0, i) = std::sqrt(d_sq[0]);
+      std::copy(q, q + 3, cache.anchors.colptr(i));
+      size_t * cands = cache.candidates.colptr(i);
+      for (size_t j = 0; j < k; ++j) {
+        cands[j] = (j < found) ? idx[j] : size();
+      }
+      cache.radii(i) = (found > k) ? std::sqrt(d_sq[k]) : std::numeric_limits<double>::infinity();
+    }
+  }
+  return n_searched;
+}
@@ -11,12 +11,85 @@ namespace transforms {
  *
  * @param [in] src_pts points to transform
  * @param [in] dst_pts target points
- * @param [in] corrs mapping of indices from src_pts to dst_pts
+ * @param [in] corrs mapping of indices from src_pts to dst_pts (if empty, column i of src_pts
+ * corresponds to column i of dst_pts)
  * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
- * @return
+ * @param [in] use_weights if true, weight each correspondence by its value in `corrs`
+ * @return true if a transformation was found, false otherwise
  *
  * @note src_pts and dst_pts must have the same number of columns
+ * @note centroids and cross-covariance are accumulated in a single pass straight from the index
+ * pairs; no point is copied and nothing is allocated on the heap
  */
 bool best_fit_transform(arma::mat const & src_pts, arma::mat const & dst_pts,
-    correspondences::correspondences_t const & corrs, arma::mat44 & H_optimal) noexcept;
+    correspondences::correspondences_t const & corrs, arma::mat44 & H_optimal,
+    bool const & use_weights = false) noexcept;
+
+/**
+ * @brief Identify best rotation and translation from the cross-covariance and centroids of two
+ * sets of points with known correspondences
+ *
+ * @param [in] C cross-covariance, sum_k (s_k - src_centroid) * (d_k - dst_centroid).t()
+ * @param [in] src_centroid centroid of (corresponding) source points
+ * @param [in] dst_centroid centroid of (corresponding) target points
+ * @param [in][out] R best-fit rotation
+ * @param [in][out] t best-fit translation
+ * @return
+ *
+ * @note allows callers to accumulate C without gathering the point sets first
+ * @note solved in closed form (Horn's quaternion method): the rotation is given by the unit
+ * eigenvector of the largest eigenvalue of a symmetric 4x4 matrix built from C, found with cyclic
+ * Jacobi sweeps; the result is always a proper rotation and nothing is allocated on the heap
+ */
+void best_fit_from_covariance(arma::mat33 const & C, arma::vec3 const & src_centroid,
+    arma::vec3 const & dst_centroid, arma::mat33 & R, arma::vec3 & t) noexcept;
+
+/**
+ * @brief Identify best transformations for a batch of small, independent problems with known
+ * correspondences
+ *
+ * @param [in] src_pts source points of all problems (no. of problems x no. of points x 3):
+ * element (b, k, r) is coordinate r of point k of problem b
+ * @param [in] dst_pts target points, same layout; dst_pts(b, k, :) corresponds to src_pts(b, k, :)
+ * @param [in] weights per-correspondence weights (no. of problems x no. of points); empty for unit
+ * weights
+ * @param [in][out] R best-fit rotations (3 x 3 x no. of problems)
+ * @param [in][out] t best-fit translations (3 x no. of problems)
+ * @return true if transformations were found, false otherwise
+ *
+ * @note structure-of-arrays layout: problems vary fastest, so every stage (centroids,
+ * cross-covariances and the rotation solve of `closest_rotations`) runs across problems in SIMD
+ * lanes
+ * @note problems with fewer correspondences are padded with zero-weight (finite) points
+ */
+bool best_fit_transforms(arma::cube const & src_pts, arma::cube const & dst_pts,
+    arma::mat const & weights, arma::cube & R, arma::mat & t) noexcept;
+
+/**
+ * @brief Closest proper rotation to a 3x3 matrix
+ *
+ * @param [in] A matrix
+ * @param [in][out] R rotation maximizing trace(R.t() * A); for A = U * S * V.t(),
+ * R = U * diag(1, 1, det(U * V.t())) * V.t()
+ * @return
+ *
+ * @note this is the rotation factor of the polar decomposition of A when det(A) > 0; reflections
+ * (det(A) < 0) are handled by construction, since Horn's quaternion method only yields rotations
+ * @note dedicated 3x3 kernel (cyclic Jacobi on a symmetric 4x4 matrix); no LAPACK call and nothing
+ * is allocated on the heap
+ */
+void closest_rotation(arma::mat33 const & A, arma::mat33 & R) noexcept;
+
+/**
+ * @brief Closest proper rotations to a batch of 3x3 matrices
+ *
+ * @param [in] A matrices (3 x 3 x no. of matrices)
+ * @param [in][out] R rotations (3 x 3 x no. of matrices); R.slice(b) maximizes
+ * trace(R.slice(b).t() * A.slice(b))
+ * @return
+ *
+ * @note SIMD version of `closest_rotation`: matrices are transposed into structure-of-arrays
+ * layout and solved across SIMD lanes with a fixed number of Jacobi sweeps
+ */
+void closest_rotations(arma::cube const & A, arma::cube & R) noexcept;
 }  // namespace transforms
@@ -1,14 +1,239 @@
 //! c/c++ headers
+#include <cmath>
 #include <iostream>
+#include <vector>
 //! dependency headers
 //! project headers
-#include "transforms/common/utilities.hpp"  // for enumerate definition
 #include "transforms/svd/svd.hpp"
 
 namespace cor = correspondences;
 
+namespace {
+/**
+ * @brief Eigenvector of the largest eigenvalue of a symmetric 4x4 matrix (cyclic Jacobi)
+ *
+ * @param [in][out] A symmetric matrix; overwritten (diagonalized)
+ * @param [in][out] q unit eigenvector of the largest eigenvalue
+ * @return
+ */
+void max_eigenvector(double A[4][4], double q[4]) noexcept {
+  double V[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+  //! Jacobi converges quadratically; a handful of sweeps reaches machine precision
+  for (size_t sweep = 0; sweep < 32; ++sweep) {
+    double off = 0, diag = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      diag += A[i][i] * A[i][i];
+      for (size_t j = i + 1; j < 4; ++j) {
+        off += A[i][j] * A[i][j];
+      }
+    }
+    if (off <= 1e-36 * diag || off == 0) {
+      break;
+    }
+    for (size_t p = 0; p < 3; ++p) {
+      for (size_t r = p + 1; r < 4; ++r) {
+        if (A[p][r] == 0) {
+          continue;
+        }
+        //! rotation in the (p, r) plane that zeroes A[p][r]
+        double const theta = (A[r][r] - A[p][p]) / (2 * A[p][r]);
+        double const t = std::copysign(1., theta) /
+          (std::abs(theta) + std::sqrt(theta * theta + 1));
+        double const c = 1 / std::sqrt(t * t + 1);
+        double const s = t * c;
+        for (size_t k = 0; k < 4; ++k) {
+          double const akp = A[k][p], akr = A[k][r];
+          A[k][p] = c * akp - s * akr;
+          A[k][r] = s * akp + c * akr;
+        }
+        for (size_t k = 0; k < 4; ++k) {
+          double const apk = A[p][k], ark = A[r][k];
+          A[p][k] = c * apk - s * ark;
+          A[r][k] = s * apk + c * ark;
+        }
+        for (size_t k = 0; k < 4; ++k) {
+          double const vkp = V[k][p], vkr = V[k][r];
+          V[k][p] = c * vkp - s * vkr;
+          V[k][r] = s * vkp + c * vkr;
+        }
+      }
+    }
+  }
+
+  size_t best = 0;
+  for (size_t i = 1; i < 4; ++i) {
+    if (A[i][i] > A[best][best]) {
+      best = i;
+    }
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    q[i] = V[i][best];
+  }
+  return;
+}
+
+//! number of Jacobi sweeps in the batched solver (lanes cannot stop independently); the scalar
+//! solver typically converges to machine precision in 4-5
+constexpr size_t batch_sweeps = 8;
+
+/**
+ * @brief Horn's symmetric 4x4 matrix: its eigenvector of the largest eigenvalue is the unit
+ * quaternion (w, x, y, z) of the rotation R maximizing trace(R * C)
+ *
+ * @param [in] C cross-covariance (row-major)
+ * @param [in][out] N Horn's matrix
+ * @return
+ */
+inline void horn_matrix(double const C[3][3], double N[4][4]) noexcept {
+  N[0][0] = C[0][0] + C[1][1] + C[2][2];
+  N[1][1] = C[0][0] - C[1][1] - C[2][2];
+  N[2][2] = -C[0][0] + C[1][1] - C[2][2];
+  N[3][3] = -C[0][0] - C[1][1] + C[2][2];
+  N[0][1] = N[1][0] = C[1][2] - C[2][1];
+  N[0][2] = N[2][0] = C[2][0] - C[0][2];
+  N[0][3] = N[3][0] = C[0][1] - C[1][0];
+  N[1][2] = N[2][1] = C[0][1] + C[1][0];
+  N[1][3] = N[3][1] = C[2][0] + C[0][2];
+  N[2][3] = N[3][2] = C[1][2] + C[2][1];
+  return;
+}
+
+/**
+ * @brief Rotation matrix of a unit quaternion
+ *
+ * @param [in] q unit quaternion (w, x, y, z)
+ * @param [in][out] R rotation matrix (any type with 3x3 element access)
+ * @return
+ */
+template <typename M>
+void rotation_from_quaternion(double const q[4], M & R) noexcept {
+  double const w = q[0], x = q[1], y = q[2], z = q[3];
+  R(0, 0) = 1 - 2 * (y * y + z * z);
+  R(0, 1) = 2 * (x * y - w * z);
+  R(0, 2) = 2 * (x * z + w * y);
+  R(1, 0) = 2 * (x * y + w * z);
+  R(1, 1) = 1 - 2 * (x * x + z * z);
+  R(1, 2) = 2 * (y * z - w * x);
+  R(2, 0) = 2 * (x * z - w * y);
+  R(2, 1) = 2 * (y * z + w * x);
+  R(2, 2) = 1 - 2 * (x * x + y * y);
+  return;
+}
+
+/**
+ * @brief Rotation maximizing trace(R * C) (scalar)
+ *
+ * @param [in] C cross-covariance (row-major)
+ * @param [in][out] R rotation
+ * @return
+ */
+void rotation_from_cross(double const C[3][3], arma::mat33 & R) noexcept {
+  double N[4][4];
+  horn_matrix(C, N);
+  double q[4];
+  max_eigenvector(N, q);
+  rotation_from_quaternion(q, R);
+  return;
+}
+
+/**
+ * @brief Rotations maximizing trace(R_b * C_b) for a batch of cross-covariances (SIMD across
+ * the batch)
+ *
+ * @param [in] C cross-covariances, entry (r, c) of all matrices at [(3 * r + c) * n, ... + n)
+ * @param [in] n no. of matrices
+ * @param [in][out] R rotations (3 x 3 x n)
+ * @return
+ */
+void rotations_from_cross(std::vector<double> const & C, size_t const & n,
+    arma::cube & R) noexcept {
+  //! Horn's matrices and eigenvector accumulators, entry (i, j) of all problems at
+  //! [(4 * i + j) * n, (4 * i + j + 1) * n)
+  std::vector<double> A(16 * n), V(16 * n, 0.);
+  auto const a = [&A, n](size_t const & i, size_t const & j) { return A.data() + (4 * i + j) * n; };
+  auto const v = [&V, n](size_t const & i, size_t const & j) { return V.data() + (4 * i + j) * n; };
+  auto const c = [&C, n](size_t const & i, size_t const & j) { return C.data() + (3 * i + j) * n; };
+  #pragma omp simd
+  for (size_t b = 0; b < n; ++b) {
+    a(0, 0)[b] = c(0, 0)[b] + c(1, 1)[b] + c(2, 2)[b];
+    a(1, 1)[b] = c(0, 0)[b] - c(1, 1)[b] - c(2, 2)[b];
+    a(2, 2)[b] = -c(0, 0)[b] + c(1, 1)[b] - c(2, 2)[b];
+    a(3, 3)[b] = -c(0, 0)[b] - c(1, 1)[b] + c(2, 2)[b];
+    a(0, 1)[b] = a(1, 0)[b] = c(1, 2)[b] - c(2, 1)[b];
+    a(0, 2)[b] = a(2, 0)[b] = c(2, 0)[b] - c(0, 2)[b];
+    a(0, 3)[b] = a(3, 0)[b] = c(0, 1)[b] - c(1, 0)[b];
+    a(1, 2)[b] = a(2, 1)[b] = c(0, 1)[b] + c(1, 0)[b];
+    a(1, 3)[b] = a(3, 1)[b] = c(2, 0)[b] + c(0, 2)[b];
+    a(2, 3)[b] = a(3, 2)[b] = c(1, 2)[b] + c(2, 1)[b];
+    for (size_t i = 0; i < 4; ++i) {
+      v(i, i)[b] = 1;
+    }
+  }
+
+  //! cyclic Jacobi sweeps, branch-free across problems
+  for (size_t sweep = 0; sweep < batch_sweeps; ++sweep) {
+    for (size_t p = 0; p < 3; ++p) {
+      for (size_t r = p + 1; r < 4; ++r) {
+        #pragma omp simd
+        for (size_t b = 0; b < n; ++b) {
+          double const apr = a(p, r)[b];
+          bool const done = (apr == 0);
+          double const theta = (a(r, r)[b] - a(p, p)[b]) / (done ? 1. : 2 * apr);
+          double const tn = done ? 0. : std::copysign(1., theta) /
+            (std::abs(theta) + std::sqrt(theta * theta + 1));
+          double const cs = 1 / std::sqrt(tn * tn + 1);
+          double const sn = tn * cs;
+          for (size_t k = 0; k < 4; ++k) {
+            double const akp = a(k, p)[b], akr = a(k, r)[b];
+            a(k, p)[b] = cs * akp - sn * akr;
+            a(k, r)[b] = sn * akp + cs * akr;
+          }
+          for (size_t k = 0; k < 4; ++k) {
+            double const apk = a(p, k)[b], ark = a(r, k)[b];
+            a(p, k)[b] = cs * apk - sn * ark;
+            a(r, k)[b] = sn * apk + cs * ark;
+          }
+          for (size_t k = 0; k < 4; ++k) {
+            double const vkp = v(k, p)[b], vkr = v(k, r)[b];
+            v(k, p)[b] = cs * vkp - sn * vkr;
+            v(k, r)[b] = sn * vkp + cs * vkr;
+          }
+        }
+      }
+    }
+  }
+
+  //! rotation from the eigenvector of the largest eigenvalue
+  R.set_size(3, 3, n);
+  for (size_t b = 0; b < n; ++b) {
+    size_t best = 0;
+    for (size_t i = 1; i < 4; ++i) {
+      if (a(i, i)[b] > a(best, best)[b]) {
+        best = i;
+      }
+    }
+    double const q[4] = {v(0, best)[b], v(1, best)[b], v(2, best)[b], v(3, best)[b]};
+    arma::mat & Rb = R.slice(b);
+    rotation_from_quaternion(q, Rb);
+  }
+  return;
+}
+}  // namespace
+
+/**
+ * @brief Identify best transformation between two sets of points with known correspondences 
+ *
+ * @param [in] src_pts points to transform
+ * @param [in] dst_pts target points
+ * @param [in] corrs mapping of indices from src_pts to dst_pts (if empty, column i of src_pts
+ * corresponds to column i of dst_pts)
+ * @param [in][out] H_optimal best-fit transformation to align points in homogeneous coordinates
+ * @param [in] use_weights if true, weight each correspondence by its value in `corrs`
+ * @return true if a transformation was found, false otherwise
+ */
 bool transforms::best_fit_transform(arma::mat const & src_pts, arma::mat const & dst_pts,
-    cor::correspondences_t const & corrs, arma::mat44 & H_optimal) noexcept {
+    cor::correspondences_t const & corrs, arma::mat44 & H_optimal,
+    bool const & use_weights) noexcept {
   // LCOV_EXCL_START
   //! input checking
   if (src_pts.n_rows != 3) {
@@ -23,66 +248,259 @@ bool transforms::best_fit_transform(arma::mat const & src_pts, arma::mat const &
     std::cout << static_cast<std::string>(__func__) <<
         ": First and second arguments must have same number of columns" << std::endl;
     return false;
+  } else if (src_pts.n_cols == 0) {
+    std::cout << static_cast<std::string>(__func__) <<
+        ": First and second arguments must have at least one column" << std::endl;
+    return false;
   }
   // LCOV_EXCL_STOP
 
-  arma::mat source_pts_align(arma::size(src_pts));
-  arma::mat target_pts_align(arma::size(dst_pts));
-
-  if (corrs.size() > 0) {
-    source_pts_align.set_size(src_pts.n_rows, corrs.size());
-    target_pts_align.set_size(dst_pts.n_rows, corrs.size());
-    arma::uvec src_inds(corrs.size());
-    arma::uvec tgt_inds(corrs.size());
-    for (auto [i, c] : enumerate(corrs)) {
-      auto const p = c.first;
-      src_inds(i) = p.first;
-      tgt_inds(i) = p.second;
+  //! single pass: weighted sums of points and of their outer products, taken relative to a
+  //! reference pair to limit cancellation when the points are far from the origin
+  size_t const ref_src = corrs.empty() ? 0 : corrs.begin()->first.first;
+  size_t const ref_dst = corrs.empty() ? 0 : corrs.begin()->first.second;
+  double const * s0 = src_pts.colptr(ref_src);
+  double const * d0 = dst_pts.colptr(ref_dst);
+  double weight_sum = 0;
+  arma::vec3 src_sum(arma::fill::zeros), dst_sum(arma::fill::zeros);
+  arma::mat33 cross_sum(arma::fill::zeros);
+  auto accumulate = [&](size_t const & i, size_t const & j, double const & w) {
+    double const * s = src_pts.colptr(i);
+    double const * d = dst_pts.colptr(j);
+    double const sr[3] = {s[0] - s0[0], s[1] - s0[1], s[2] - s0[2]};
+    double const dr[3] = {d[0] - d0[0], d[1] - d0[1], d[2] - d0[2]};
+    weight_sum += w;
+    for (size_t c = 0; c < 3; ++c) {
+      src_sum(c) += w * sr[c];
+      dst_sum(c) += w * dr[c];
+      for (size_t r = 0; r < 3; ++r) {
+        cross_sum(r, c) += w * sr[r] * dr[c];
+      }
+    }
+  };
+  if (corrs.empty()) {
+    for (size_t i = 0; i < src_pts.n_cols; ++i) {
+      accumulate(i, i, 1);
     }
-
-    //! order points based on correspondences
-    source_pts_align = src_pts.cols(src_inds);
-    target_pts_align = dst_pts.cols(tgt_inds);
   } else {
-    source_pts_align = src_pts;
-    target_pts_align = dst_pts;
+    for (auto const & c : corrs) {
+      accumulate(c.first.first, c.first.second, use_weights ? c.second : 1);
+    }
   }
 
+  // LCOV_EXCL_START
+  if (!(weight_sum > 0)) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Correspondence weights must have a positive sum" << std::endl;
+    return false;
+  }
+  // LCOV_EXCL_STOP
+
+  //! weighted centroids and cross-covariance, sum_k w_k * (s_k - src_c) * (d_k - dst_c).t()
+  arma::vec3 src_centroid, dst_centroid;
+  arma::mat33 C;
+  for (size_t c = 0; c < 3; ++c) {
+    src_centroid(c) = s0[c] + src_sum(c) / weight_sum;
+    dst_centroid(c) = d0[c] + dst_sum(c) / weight_sum;
+    for (size_t r = 0; r < 3; ++r) {
+      C(r, c) = cross_sum(r, c) - src_sum(r) * dst_sum(c) / weight_sum;
+    }
+  }
+
+  //! compute optimal rotation and translation
   arma::mat33 optimal_rot;
   arma::vec3 optimal_trans;
+  best_fit_from_covariance(C, src_centroid, dst_centroid, optimal_rot, optimal_trans);
+
+  H_optimal.zeros();
+  H_optimal(arma::span(0, 2), arma::span(0, 2)) = optimal_rot;
+  H_optimal(arma::span(0, 2), 3) = optimal_trans;
+  H_optimal(3, 3) = 1;
+  return true;
+}
 
-  //! make const ref to size
-  size_t const & n_pts = source_pts_align.n_cols;
+/**
+ * @brief Identify best rotation and translation from the cross-covariance and centroids of two
+ * sets of points with known correspondences
+ *
+ * @param [in] C cross-covariance, sum_k (s_k - src_centroid) * (d_k - dst_centroid).t()
+ * @param [in] src_centroid centroid of (corresponding) source points
+ * @param [in] dst_centroid centroid of (corresponding) target points
+ * @param [in][out] R best-fit rotation
+ * @param [in][out] t best-fit translation
+ * @return
+ */
+void transforms::best_fit_from_covariance(arma::mat33 const & C, arma::vec3 const & src_centroid,
+    arma::vec3 const & dst_centroid, arma::mat33 & R, arma::vec3 & t) noexcept {
+  //! compute optimal rotation and translation
+  double const Crm[3][3] = {{C(0, 0), C(0, 1), C(0, 2)}, {C(1, 0), C(1, 1), C(1, 2)},
+    {C(2, 0), C(2, 1), C(2, 2)}};
+  rotation_from_cross(Crm, R);
+  t = dst_centroid - R * src_centroid;
+  return;
+}
 
-  //! compute weighted centroids
-  arma::vec3 const src_centroid = arma::vec3(arma::mean(source_pts_align, 1));
-  arma::vec3 const dst_centroid = arma::vec3(arma::mean(target_pts_align, 1));
+/**
+ * @brief Identify best transformations for a batch of small, independent problems with known
+ * correspondences
+ *
+ * @param [in] src_pts source points of all problems (no. of problems x no. of points x 3):
+ * element (b, k, r) is coordinate r of point k of problem b
+ * @param [in] dst_pts target points, same layout; dst_pts(b, k, :) corresponds to src_pts(b, k, :)
+ * @param [in] weights per-correspondence weights (no. of problems x no. of points); empty for unit
+ * weights
+ * @param [in][out] R best-fit rotations (3 x 3 x no. of problems)
+ * @param [in][out] t best-fit translations (3 x no. of problems)
+ * @return true if transformations were found, false otherwise
+ */
+bool transforms::best_fit_transforms(arma::cube const & src_pts, arma::cube const & dst_pts,
+    arma::mat const & weights, arma::cube & R, arma::mat & t) noexcept {
+  // LCOV_EXCL_START
+  //! input checking
+  if (src_pts.n_slices != 3 || src_pts.n_cols == 0) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": First argument must be a cube with at least one column and 3 slices" << std::endl;
+    return false;
+  } else if (arma::size(dst_pts) != arma::size(src_pts)) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": First and second arguments must have the same size" << std::endl;
+    return false;
+  } else if (!weights.empty() && (weights.n_rows != src_pts.n_rows ||
+        weights.n_cols != src_pts.n_cols)) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": Third argument must be empty or have one weight per correspondence" << std::endl;
+    return false;
+  }
+  // LCOV_EXCL_STOP
 
-  //! translate centroid to origin
-  arma::mat const src_crep = arma::repmat(src_centroid, 1, n_pts);
-  arma::mat const dst_crep = arma::repmat(dst_centroid, 1, n_pts);
-  source_pts_align -= src_crep;
-  target_pts_align -= dst_crep;
+  size_t const n = src_pts.n_rows;
+  size_t const n_pts = src_pts.n_cols;
+  R.set_size(3, 3, n);
+  t.set_size(3, n);
+  if (n == 0) {
+    return true;
+  }
 
-  //! compute tensor product
-  arma::mat33 const C = arma::mat33(source_pts_align * target_pts_align.t());
+  //! per-problem sums, stored quantity-major so that problems are contiguous: weight (1), source
+  //! and target sums (3 + 3) and cross sums (9), all relative to each problem's first pair
+  std::vector<double> sums(16 * n, 0.);
+  double * const w_sum = sums.data();
+  double * const s_sum = w_sum + n;
+  double * const d_sum = s_sum + 3 * n;
+  double * const x_sum = d_sum + 3 * n;
+  double const * s0[3], * d0[3];
+  for (size_t r = 0; r < 3; ++r) {
+    s0[r] = src_pts.slice(r).colptr(0);
+    d0[r] = dst_pts.slice(r).colptr(0);
+  }
+  for (size_t k = 0; k < n_pts; ++k) {
+    double const * s[3], * d[3];
+    for (size_t r = 0; r < 3; ++r) {
+      s[r] = src_pts.slice(r).colptr(k);
+      d[r] = dst_pts.slice(r).colptr(k);
+    }
+    double const * w = weights.empty() ? nullptr : weights.colptr(k);
+    #pragma omp simd
+    for (size_t b = 0; b < n; ++b) {
+      double const wb = (w == nullptr) ? 1. : w[b];
+      double const sr[3] = {s[0][b] - s0[0][b], s[1][b] - s0[1][b], s[2][b] - s0[2][b]};
+      double const dr[3] = {d[0][b] - d0[0][b], d[1][b] - d0[1][b], d[2][b] - d0[2][b]};
+      w_sum[b] += wb;
+      for (size_t c = 0; c < 3; ++c) {
+        s_sum[c * n + b] += wb * sr[c];
+        d_sum[c * n + b] += wb * dr[c];
+        for (size_t r = 0; r < 3; ++r) {
+          x_sum[(3 * c + r) * n + b] += wb * sr[r] * dr[c];
+        }
+      }
+    }
+  }
 
-  //! compute the singular value decomposition
-  arma::mat33 U, V;
-  arma::vec3 s;
-  arma::svd(U, s, V, C);
+  // LCOV_EXCL_START
+  for (size_t b = 0; b < n; ++b) {
+    if (!(w_sum[b] > 0)) {
+      std::cout << static_cast<std::string>(__func__) <<
+        ": Correspondence weights of each problem must have a positive sum" << std::endl;
+      return false;
+    }
+  }
+  // LCOV_EXCL_STOP
 
-  //! compute optimal rotation and translation
-  arma::mat33 I(arma::fill::eye);
-  if (arma::det(U * V.t()) < 0) {
-    I(2, 2) *= -1;
+  //! cross-covariances about the centroids, C(r, c) = sum_k w_k (s_k - src_c)(r) (d_k - dst_c)(c),
+  //! then rotations
+  std::vector<double> C(9 * n);
+  #pragma omp simd
+  for (size_t b = 0; b < n; ++b) {
+    for (size_t r = 0; r < 3; ++r) {
+      for (size_t c = 0; c < 3; ++c) {
+        C[(3 * r + c) * n + b] = x_sum[(3 * c + r) * n + b] -
+          s_sum[r * n + b] * d_sum[c * n + b] / w_sum[b];
+      }
+    }
   }
-  optimal_rot = V * I * U.t();
-  optimal_trans = dst_centroid - optimal_rot * src_centroid;
+  rotations_from_cross(C, n, R);
 
-  H_optimal.zeros();
-  H_optimal(arma::span(0, 2), arma::span(0, 2)) = optimal_rot;
-  H_optimal(arma::span(0, 2), 3) = optimal_trans;
-  H_optimal(3, 3) = 1;
+  //! translations
+  for (size_t b = 0; b < n; ++b) {
+    arma::mat const & Rb = R.slice(b);
+    double src_c[3];
+    for (size_t r = 0; r < 3; ++r) {
+      src_c[r] = s0[r][b] + s_sum[r * n + b] / w_sum[b];
+    }
+    for (size_t r = 0; r < 3; ++r) {
+      t(r, b) = d0[r][b] + d_sum[r * n + b] / w_sum[b] -
+        (Rb(r, 0) * src_c[0] + Rb(r, 1) * src_c[1] + Rb(r, 2) * src_c[2]);
+    }
+  }
   return true;
 }
+
+/**
+ * @brief Closest proper rotation to a 3x3 matrix
+ *
+ * @param [in] A matrix
+ * @param [in][out] R rotation maximizing trace(R.t() * A); for A = U * S * V.t(),
+ * R = U * diag(1, 1, det(U * V.t())) * V.t()
+ * @return
+ */
+void transforms::closest_rotation(arma::mat33 const & A, arma::mat33 & R) noexcept {
+  //! trace(R.t() * A) = trace(R * A.t()): the cross-covariance is A.t()
+  double const C[3][3] = {{A(0, 0), A(1, 0), A(2, 0)}, {A(0, 1), A(1, 1), A(2, 1)},
+    {A(0, 2), A(1, 2), A(2, 2)}};
+  rotation_from_cross(C, R);
+  return;
+}
+
+/**
+ * @brief Closest proper rotations to a batch of 3x3 matrices
+ *
+ * @param [in] A matrices (3 x 3 x no. of matrices)
+ * @param [in][out] R rotations (3 x 3 x no. of matrices); R.slice(b) maximizes
+ * trace(R.slice(b).t() * A.slice(b))
+ * @return
+ */
+void transforms::closest_rotations(arma::cube const & A, arma::cube & R) noexcept {
+  // LCOV_EXCL_START
+  //! input checking
+  if (A.n_rows != 3 || A.n_cols != 3) {
+    std::cout << static_cast<std::string>(__func__) <<
+      ": First argument must be a cube of 3x3 slices" << std::endl;
+    return;
+  }
+  // LCOV_EXCL_STOP
+
+  //! transpose into structure-of-arrays layout (matrices fastest)
+  size_t const n = A.n_slices;
+  std::vector<double> C(9 * n);
+  for (size_t b = 0; b < n; ++b) {
+    double const * Ab = A.slice_memptr(b);
+    for (size_t r = 0; r < 3; ++r) {
+      for (size_t c = 0; c < 3; ++c) {
+        //! C = A.t(); A is column-major, so A(c, r) is at Ab[3 * r + c]
+        C[(3 * r + c) * n + b] = Ab[3 * r + c];
+      }
+    }
+  }
+  rotations_from_cross(C, n, R);
+  return;
+}